@@ -4,67 +4,104 @@
 #include "agent.h"
 
 agent newAgent(enviroment E){
+    (void)E; //o agente sempre começa em (0,0)
     agent A;
     A.score = 0;
+    A.comOuro = false;
     A.temFlecha = true;
-    A.onde = &E.grid[0][0];
+    A.row = 0;
+    A.col = 0;
     return A;
 }
 
-void sense(agent A){
-    if (A.onde->S.cheiro){
+void sense(agent A, enviroment E){
+    place* onde = getPlace(E,A.row,A.col);
+    if (onde->S.cheiro){
         printf("Aqui há um cheiro monstruoso. \n");
     }
-    if (A.onde->S.vento){
+    if (onde->S.vento){
         printf("Aqui está batendo um vento estranho. \n");
     }
 }
 
-bool move(agent* A, enviroment E, place* target){
+int stepPlace(agent* A, int h, int w, place* target){
 /*
-    Movimenta o agente para a posição place, desde que esta seja uma vizinha de
-    cleaner.ondeCleaner e que a bateria de C não esteja vazia.
+    Aplica as regras de movimento sem nenhuma saída, retornando os eventos
+    ocorridos (EV_*). Retorna 0 se target não for vizinho da posição atual.
+    Só escreve em target se o monstro for morto. Não depende de como o grid
+    está guardado, apenas das suas dimensões h e w.
 */
-    if (isNeighbor(*A->onde,*target)){
-        A->onde = target;
-        A->score--;
-        if (A->onde->monstro){
-            if (A->temFlecha){
-                printf("Matou o monstro. \n");
-                A->score -= 10;
-                A->onde->monstro = false;
-            }
-            else{
-                printf("Pego pelo monstro.\n");
-                A->score -= 1000;
-            }
+    int dr = target->row-A->row, dc = target->col-A->col;
+    if (!((dr==0 && (dc==1 || dc==-1)) || (dc==0 && (dr==1 || dr==-1))))
+        return 0;
+    int ev = EV_MOVEU;
+    A->row = target->row;
+    A->col = target->col;
+    A->score--;
+    if (target->monstro){
+        if (A->temFlecha){
+            ev |= EV_MATOU;
+            A->score -= 10;
+            target->monstro = false;
         }
-        if (A->onde->buraco){
-            printf("Caiu no buraco. \n");
+        else{
+            ev |= EV_PEGO;
             A->score -= 1000;
         }
-        if (A->onde->ouro){
-            printf("O ouro está aqui! \n");
-            A->comOuro = true;
-        }
-        if (A->comOuro && A->onde->row==E.h-1 && A->onde->col==E.w-1){
-            printf("Escapou com o ouro! Parabéns. \n");
-        }
-        return true;
     }
-    return false;
+    if (target->buraco){
+        ev |= EV_BURACO;
+        A->score -= 1000;
+    }
+    if (target->ouro){
+        ev |= EV_OURO;
+        A->comOuro = true;
+    }
+    if (A->comOuro && A->row==h-1 && A->col==w-1){
+        ev |= EV_ESCAPOU;
+    }
+    return ev;
+}
+
+int step(agent* A, enviroment E, place* target){
+    return stepPlace(A,E.h,E.w,target);
+}
+
+bool move(agent* A, enviroment E, place* target){
+/*
+    Movimenta o agente para a posição place, desde que esta seja uma vizinha de
+    cleaner.ondeCleaner e que a bateria de C não esteja vazia.
+*/
+    int ev = step(A,E,target);
+    if (ev & EV_MATOU)
+        printf("Matou o monstro. \n");
+    if (ev & EV_PEGO)
+        printf("Pego pelo monstro.\n");
+    if (ev & EV_BURACO)
+        printf("Caiu no buraco. \n");
+    if (ev & EV_OURO)
+        printf("O ouro está aqui! \n");
+    if (ev & EV_ESCAPOU)
+        printf("Escapou com o ouro! Parabéns. \n");
+    return ev!=0;
 }
 
 void printSimulation(agent A, enviroment E){
+/*
+    Monta o grid inteiro num buffer e escreve de uma vez só.
+*/
+    size_t len = ((size_t)2*E.w+1)*E.h;
+    char* buf = malloc(len);
+    if (buf==NULL)
+        return;
+    char* c = buf;
     for (int i=0; i<E.h; i++){
         for (int j=0; j<E.w; j++){
-            if (&E.grid[i][j]==A.onde){
-                printf("O ");
-            }
-            else{
-                printf("_ ");
-            }
+            *c++ = (i==A.row && j==A.col) ? 'O' : '_';
+            *c++ = ' ';
         }
-        printf("\n");
+        *c++ = '\n';
     }
-}
\ No newline at end of file
+    fwrite(buf,1,len,stdout);
+    free(buf);
+}
@@ -3,16 +3,28 @@
 #ifndef AGENT_H
 #define AGENT_H
 
+//A posição é guardada em coordenadas (e não como ponteiro para o grid), para
+//que cópias do agente continuem válidas junto com cópias do ambiente
 typedef struct {
-    place* onde;
+    int row, col;
     bool comOuro;
     bool temFlecha;
     int score;
 }agent;
 
+//Eventos de um passo do agente (combinados em bits)
+#define EV_MOVEU    1   //o agente mudou de lugar
+#define EV_MATOU    2   //matou o monstro com a flecha
+#define EV_PEGO     4   //foi pego pelo monstro
+#define EV_BURACO   8   //caiu no buraco
+#define EV_OURO     16  //encontrou o ouro
+#define EV_ESCAPOU  32  //chegou na saída com o ouro
+
 void printSimulation(agent A, enviroment E);
+int stepPlace(agent* A, int h, int w, place* target);
+int step(agent* A, enviroment E, place* target);
 bool move(agent* A, enviroment E, place* target);
 agent newAgent(enviroment E);
-void sense(agent A);
+void sense(agent A, enviroment E);
 
 #endif 
\ No newline at end of file
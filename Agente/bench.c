@@ -0,0 +1,266 @@
+#define _DEFAULT_SOURCE   //wait4 e clock_gettime com -std=c11
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "agent.h"
+#include "rng.h"
+
+/*
+    Benchmark do ambiente e do agente: mede newEnviroment, initEnviroment,
+    initSensations, delEnviroment e a vazão de step() para vários tamanhos
+    de grid e densidades de perigos. Reporta média e desvio padrão (como a
+    avaliação do Grafo), percentis e pico de memória; opcionalmente em JSON.
+    Cada configuração roda num processo filho, para que o pico de memória
+    (ru_maxrss do filho) seja só dela e não o máximo acumulado do processo.
+
+    Uso: bench [--max N] [--reps N] [--json arquivo]
+*/
+
+typedef struct{
+    double media, desvio, min, p50, p90, p99, max;
+} estatisticas;
+
+static double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static int cmpDouble(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x>y)-(x<y);
+}
+
+static double percentil(const double* v, int n, double p){
+//Interpolação linear entre as amostras ordenadas
+    if (n==1) return v[0];
+    double pos = p*(n-1);
+    int k = (int)pos;
+    if (k>=n-1) return v[n-1];
+    return v[k] + (pos-k)*(v[k+1]-v[k]);
+}
+
+static estatisticas calcula(double* v, int n){
+    estatisticas E;
+    double soma = 0.0;
+    for (int k=0; k<n; k++) soma += v[k];
+    E.media = soma/n;
+    double sq = 0.0;
+    for (int k=0; k<n; k++) sq += (v[k]-E.media)*(v[k]-E.media);
+    E.desvio = n>1 ? sqrt(sq/(n-1)) : 0.0;
+    qsort(v,n,sizeof(double),cmpDouble);
+    E.min = v[0]; E.max = v[n-1];
+    E.p50 = percentil(v,n,0.50);
+    E.p90 = percentil(v,n,0.90);
+    E.p99 = percentil(v,n,0.99);
+    return E;
+}
+
+
+static void imprime(const char* nome, estatisticas E, const char* unidade){
+    printf("    %-16s media %12.2f  desvio %10.2f  p50 %12.2f  p90 %12.2f  p99 %12.2f %s\n",
+        nome,E.media,E.desvio,E.p50,E.p90,E.p99,unidade);
+}
+
+static void jsonStats(FILE* J, const char* nome, estatisticas E, bool virgula){
+    fprintf(J,"      \"%s\": {\"media\": %.3f, \"desvio\": %.3f, \"min\": %.3f, "
+        "\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+        nome,E.media,E.desvio,E.min,E.p50,E.p90,E.p99,E.max,virgula ? "," : "");
+}
+
+//Ordem das medidas em mede()
+enum { M_NEW, M_INIT, M_SENS, M_DEL, M_STEP, NUM_MEDIDAS };
+
+static bool mede(int lado, int numBuraco, int numMonstro, int reps,
+    estatisticas s[NUM_MEDIDAS]){
+/*
+    Roda as repetições de uma configuração. Retorna falso se faltar memória.
+*/
+    const int passosMove = 1000000;
+    double* t[NUM_MEDIDAS];
+    bool ok = true;
+    for (int m=0; m<NUM_MEDIDAS; m++){
+        t[m] = malloc(reps*sizeof(double));
+        if (t[m]==NULL) ok = false;
+    }
+    rngState r = newRng(12345+lado);
+    for (int k=0; ok && k<reps; k++){
+        double t0 = now();
+        enviroment E = newEnviroment(lado,lado);
+        double t1 = now();
+        if (E.grid==NULL){
+            ok = false;
+            break;
+        }
+        initEnviromentSeed(E,numBuraco,numMonstro,rngNext(&r));
+        double t2 = now();
+        initSensations(E);
+        double t3 = now();
+
+        //Vazão de step(): passeio aleatório dentro do grid
+        agent A = newAgent(E);
+        int n = reps>20 ? passosMove/20 : passosMove;
+        double t4 = now();
+        for (int p=0; p<n; p++){
+            uint64_t x = rngNext(&r);
+            int i = A.row, j = A.col;
+            switch (x&3){
+                case 0: i++; break;
+                case 1: i--; break;
+                case 2: j++; break;
+                default: j--; break;
+            }
+            if (i<0 || i>=E.h || j<0 || j>=E.w)
+                continue;
+            step(&A,E,getPlace(E,i,j));
+        }
+        double t5 = now();
+
+        delEnviroment(&E);
+        double t6 = now();
+
+        t[M_NEW][k] = (t1-t0)*1e9;
+        t[M_INIT][k] = (t2-t1)*1e9;
+        t[M_SENS][k] = (t3-t2)*1e9;
+        t[M_DEL][k] = (t6-t5)*1e9;
+        t[M_STEP][k] = n/(t5-t4);
+    }
+    for (int m=0; m<NUM_MEDIDAS; m++){
+        if (ok) s[m] = calcula(t[m],reps);
+        free(t[m]);
+    }
+    return ok;
+}
+
+static bool medeEmFilho(int lado, int numBuraco, int numMonstro, int reps,
+    estatisticas s[NUM_MEDIDAS], long* picoKB){
+/*
+    Roda mede() num processo filho, que devolve as estatísticas por um pipe.
+    O pico de memória vem do rusage desse filho (wait4), então não carrega
+    o que configurações anteriores alocaram.
+*/
+    int fd[2];
+    if (pipe(fd)<0)
+        return false;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid<0){
+        close(fd[0]); close(fd[1]);
+        return false;
+    }
+    if (pid==0){
+        close(fd[0]);
+        bool ok = mede(lado,numBuraco,numMonstro,reps,s);
+        if (ok && write(fd[1],s,NUM_MEDIDAS*sizeof(estatisticas))
+                != (ssize_t)(NUM_MEDIDAS*sizeof(estatisticas)))
+            ok = false;
+        close(fd[1]);
+        _exit(ok ? 0 : 1);
+    }
+    close(fd[1]);
+    size_t lidos = 0, total = NUM_MEDIDAS*sizeof(estatisticas);
+    while (lidos<total){
+        ssize_t n = read(fd[0],(char*)s+lidos,total-lidos);
+        if (n<=0) break;
+        lidos += n;
+    }
+    close(fd[0]);
+    int status;
+    struct rusage u;
+    if (wait4(pid,&status,0,&u)<0)
+        return false;
+    *picoKB = u.ru_maxrss;
+    return lidos==total && WIFEXITED(status) && WEXITSTATUS(status)==0;
+}
+
+int main(int argc, char** argv){
+    int maxLado = 4096;
+    int repsBase = 200;
+    const char* arquivoJson = NULL;
+    for (int a=1; a<argc; a++){
+        if (!strcmp(argv[a],"--max") && a+1<argc) maxLado = atoi(argv[++a]);
+        else if (!strcmp(argv[a],"--reps") && a+1<argc) repsBase = atoi(argv[++a]);
+        else if (!strcmp(argv[a],"--json") && a+1<argc) arquivoJson = argv[++a];
+        else{
+            fprintf(stderr,"Uso: %s [--max N] [--reps N] [--json arquivo]\n",argv[0]);
+            return 1;
+        }
+    }
+    if (repsBase<2) repsBase = 2;
+
+    const int lados[] = {5, 16, 64, 256, 1024, 4096};
+    const double densidades[] = {0.05, 0.20};
+    FILE* J = NULL;
+    if (arquivoJson!=NULL){
+        J = fopen(arquivoJson,"w");
+        if (J==NULL){
+            fprintf(stderr,"Erro: nao foi possivel abrir %s\n",arquivoJson);
+            return 1;
+        }
+        fprintf(J,"{\n  \"resultados\": [\n");
+    }
+    bool primeiro = true;
+
+    printf("Benchmark do Agente (tempos em ns, vazao em passos/s)\n");
+    printf("------------------------------------------------\n");
+
+    for (size_t l=0; l<sizeof(lados)/sizeof(lados[0]); l++){
+        int lado = lados[l];
+        if (lado>maxLado) break;
+        for (size_t d=0; d<sizeof(densidades)/sizeof(densidades[0]); d++){
+            double dens = densidades[d];
+            long interior = (long)(lado-2)*(lado-2);
+            int numBuraco = (int)(dens*interior);
+            int numMonstro = (int)(dens*interior/4);
+
+            //Menos repetições para grids grandes, ao menos 5
+            long cells = (long)lado*lado;
+            int reps = (int)(repsBase*256.0/(cells<256 ? 256 : cells)*64);
+            if (reps>repsBase) reps = repsBase;
+            if (reps<5) reps = 5;
+
+            estatisticas st[NUM_MEDIDAS];
+            long pico = 0;
+            if (!medeEmFilho(lado,numBuraco,numMonstro,reps,st,&pico)){
+                fprintf(stderr,"Erro ao medir o grid %dx%d.\n",lado,lado);
+                return 1;
+            }
+
+            printf("\n--- Grid %dx%d, densidade %.2f (%d buracos, %d monstros), %d repeticoes ---\n",
+                lado,lado,dens,numBuraco,numMonstro,reps);
+            imprime("newEnviroment",st[M_NEW],"ns");
+            imprime("initEnviroment",st[M_INIT],"ns");
+            imprime("initSensations",st[M_SENS],"ns");
+            imprime("delEnviroment",st[M_DEL],"ns");
+            imprime("step",st[M_STEP],"passos/s");
+            printf("    Pico de memoria: %ld KB\n",pico);
+
+            if (J!=NULL){
+                fprintf(J,"%s    {\n",primeiro ? "" : ",\n");
+                fprintf(J,"      \"lado\": %d, \"densidade\": %.2f, \"buracos\": %d, "
+                    "\"monstros\": %d, \"repeticoes\": %d, \"pico_memoria_kb\": %ld,\n",
+                    lado,dens,numBuraco,numMonstro,reps,pico);
+                jsonStats(J,"newEnviroment_ns",st[M_NEW],true);
+                jsonStats(J,"initEnviroment_ns",st[M_INIT],true);
+                jsonStats(J,"initSensations_ns",st[M_SENS],true);
+                jsonStats(J,"delEnviroment_ns",st[M_DEL],true);
+                jsonStats(J,"step_passos_por_s",st[M_STEP],false);
+                fprintf(J,"    }");
+                primeiro = false;
+            }
+        }
+    }
+
+    if (J!=NULL){
+        fprintf(J,"\n  ]\n}\n");
+        fclose(J);
+    }
+    printf("\n------------------------------------------------\n");
+    printf("Benchmark Concluido.\n");
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "bitenv.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*------------------------------------------------------------------------------
+    Alocação e conversão
+------------------------------------------------------------------------------*/
+
+static uint64_t* newPlane(int h, int pitch){
+    return calloc((size_t)(h+2)*pitch, sizeof(uint64_t));
+}
+
+bitEnviroment newBitEnviroment(int h, int w){
+/*
+    Aloca os cinco planos zerados (incluindo as guardas).
+*/
+    bitEnviroment B;
+    B.h = h; B.w = w;
+    B.stride = (w+63)/64;
+    B.pitch = B.stride+2;
+    B.buraco = newPlane(h,B.pitch);
+    B.monstro = newPlane(h,B.pitch);
+    B.ouro = newPlane(h,B.pitch);
+    B.vento = newPlane(h,B.pitch);
+    B.cheiro = newPlane(h,B.pitch);
+    return B;
+}
+
+void delBitEnviroment(bitEnviroment* B){
+    if (B!=NULL){
+        free(B->buraco); free(B->monstro); free(B->ouro);
+        free(B->vento); free(B->cheiro);
+        B->buraco = B->monstro = B->ouro = B->vento = B->cheiro = NULL;
+    }
+}
+
+bitEnviroment bitFromEnviroment(enviroment E){
+/*
+    Aloca um ambiente em planos de bits com o conteúdo de E.
+*/
+    bitEnviroment B = newBitEnviroment(E.h,E.w);
+    if (B.buraco==NULL || B.monstro==NULL || B.ouro==NULL
+        || B.vento==NULL || B.cheiro==NULL)
+        return B;
+    bitLoadEnviroment(B,E);
+    return B;
+}
+
+void bitLoadEnviroment(bitEnviroment B, enviroment E){
+/*
+    Empacota os buracos, monstros e ouro de E (de mesmo tamanho) em planos
+    já alocados e calcula as sensações. As guardas continuam zeradas.
+*/
+    for (int i=0; i<E.h; i++){
+        memset(bitRow(&B,B.buraco,i),0,B.stride*sizeof(uint64_t));
+        memset(bitRow(&B,B.monstro,i),0,B.stride*sizeof(uint64_t));
+        memset(bitRow(&B,B.ouro,i),0,B.stride*sizeof(uint64_t));
+        for (int j=0; j<E.w; j++){
+            place* p = getPlace(E,i,j);
+            if (p->buraco)  bitSet(&B,B.buraco,i,j,true);
+            if (p->monstro) bitSet(&B,B.monstro,i,j,true);
+            if (p->ouro)    bitSet(&B,B.ouro,i,j,true);
+        }
+    }
+    bitInitSensations(B);
+}
+
+void bitToEnviroment(bitEnviroment B, enviroment E){
+/*
+    Copia todos os planos de volta para um ambiente de mesmo tamanho.
+*/
+    for (int i=0; i<E.h; i++)
+        for (int j=0; j<E.w; j++){
+            place* p = getPlace(E,i,j);
+            p->buraco = bitTest(&B,B.buraco,i,j);
+            p->monstro = bitTest(&B,B.monstro,i,j);
+            p->ouro = bitTest(&B,B.ouro,i,j);
+            p->S.vento = bitTest(&B,B.vento,i,j);
+            p->S.cheiro = bitTest(&B,B.cheiro,i,j);
+        }
+}
+
+/*------------------------------------------------------------------------------
+    Kernels de sensação
+------------------------------------------------------------------------------*/
+
+static void spreadRow(uint64_t* restrict dst, const uint64_t* restrict up,
+    const uint64_t* restrict mid, const uint64_t* restrict down, int stride,
+    uint64_t lastMask){
+/*
+    dst = vizinhos-4 de mid: linha de cima | linha de baixo | esquerda | direita.
+    O vizinho da esquerda de um bit é o bit anterior (shift para cima, com o
+    bit 63 da palavra anterior entrando no bit 0) e o da direita é o seguinte.
+    As palavras de guarda em mid[-1] e mid[stride] valem zero.
+*/
+    int k = 0;
+#ifdef __AVX2__
+    for (; k+4<=stride; k+=4){
+        __m256i u = _mm256_loadu_si256((const __m256i*)(up+k));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(down+k));
+        __m256i m = _mm256_loadu_si256((const __m256i*)(mid+k));
+        __m256i prev = _mm256_loadu_si256((const __m256i*)(mid+k-1));
+        __m256i next = _mm256_loadu_si256((const __m256i*)(mid+k+1));
+        __m256i left = _mm256_or_si256(_mm256_slli_epi64(m,1),_mm256_srli_epi64(prev,63));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(m,1),_mm256_slli_epi64(next,63));
+        __m256i r = _mm256_or_si256(_mm256_or_si256(u,d),_mm256_or_si256(left,right));
+        _mm256_storeu_si256((__m256i*)(dst+k),r);
+    }
+#endif
+    for (; k<stride; k++){
+        dst[k] = up[k] | down[k]
+            | (mid[k]<<1) | (mid[k-1]>>63)
+            | (mid[k]>>1) | (mid[k+1]<<63);
+    }
+    dst[stride-1] &= lastMask;
+}
+
+static void spreadRows(const bitEnviroment* B, uint64_t* src, uint64_t* dst,
+    int first, int last){
+    uint64_t lastMask = (B->w%64==0) ? ~(uint64_t)0 : (((uint64_t)1<<(B->w%64))-1);
+    for (int i=first; i<=last; i++)
+        spreadRow(bitRow(B,dst,i),bitRow(B,src,i-1),bitRow(B,src,i),
+            bitRow(B,src,i+1),B->stride,lastMask);
+}
+
+void bitInitSensations(bitEnviroment B){
+/*
+    Deriva vento do plano de buracos e cheiro do plano de monstros.
+*/
+    if (B.h<=0 || B.w<=0)
+        return;
+    spreadRows(&B,B.buraco,B.vento,0,B.h-1);
+    spreadRows(&B,B.monstro,B.cheiro,0,B.h-1);
+}
+
+void bitKillMonster(bitEnviroment B, int i, int j){
+/*
+    Remove o monstro de (i,j) e recalcula o cheiro só nas três linhas que
+    podem ter mudado.
+*/
+    bitSet(&B,B.monstro,i,j,false);
+    int first = i>0 ? i-1 : 0;
+    int last = i<B.h-1 ? i+1 : B.h-1;
+    spreadRows(&B,B.monstro,B.cheiro,first,last);
+}
+
+/*------------------------------------------------------------------------------
+    Regras do agente
+------------------------------------------------------------------------------*/
+
+sensation bitSensation(bitEnviroment B, int i, int j){
+    sensation S;
+    S.cheiro = bitTest(&B,B.cheiro,i,j);
+    S.vento = bitTest(&B,B.vento,i,j);
+    return S;
+}
+
+int bitStep(agent* A, bitEnviroment B, int i, int j){
+/*
+    Move o agente para (i,j) com as mesmas regras de step(). As regras
+    rodam sobre um lugar montado a partir dos planos; se o monstro for
+    morto só o bit dele é apagado. Como em step(), o cheiro em volta fica
+    como estava (bitKillMonster o recalcula).
+*/
+    if (i<0 || i>=B.h || j<0 || j>=B.w)
+        return 0;
+    place p;
+    p.row = i; p.col = j;
+    p.buraco = bitTest(&B,B.buraco,i,j);
+    p.monstro = bitTest(&B,B.monstro,i,j);
+    p.ouro = bitTest(&B,B.ouro,i,j);
+    p.S = bitSensation(B,i,j);
+    int ev = stepPlace(A,B.h,B.w,&p);
+    if (ev & EV_MATOU)
+        bitSet(&B,B.monstro,i,j,false);
+    return ev;
+}
@@ -0,0 +1,55 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "env.h"
+#include "agent.h"
+
+#ifndef BITENV_H
+#define BITENV_H
+
+/*
+    Representação alternativa do ambiente em planos de bits: cada propriedade
+    (buraco, monstro, ouro, vento, cheiro) é um bit por lugar, empacotado em
+    palavras de 64 bits linha a linha.
+
+    Cada plano tem uma linha de guarda (zerada) acima e abaixo do grid e uma
+    palavra de guarda no início e no fim de cada linha. Assim os kernels de
+    sensação leem os vizinhos sem testar bordas.
+*/
+typedef struct{
+    int h, w;
+    int stride; //palavras úteis por linha
+    int pitch;  //palavras por linha incluindo as duas guardas
+    uint64_t* buraco;
+    uint64_t* monstro;
+    uint64_t* ouro;
+    uint64_t* vento;
+    uint64_t* cheiro;
+} bitEnviroment;
+
+bitEnviroment newBitEnviroment(int h, int w);
+void delBitEnviroment(bitEnviroment* B);
+bitEnviroment bitFromEnviroment(enviroment E);
+void bitLoadEnviroment(bitEnviroment B, enviroment E);
+void bitToEnviroment(bitEnviroment B, enviroment E);
+void bitInitSensations(bitEnviroment B);
+void bitKillMonster(bitEnviroment B, int i, int j);
+sensation bitSensation(bitEnviroment B, int i, int j);
+int bitStep(agent* A, bitEnviroment B, int i, int j);
+
+//Ponteiro para a primeira palavra útil da linha i de um plano
+static inline uint64_t* bitRow(const bitEnviroment* B, uint64_t* plane, int i){
+    return plane + (size_t)(i+1)*B->pitch + 1;
+}
+
+static inline bool bitTest(const bitEnviroment* B, uint64_t* plane, int i, int j){
+    return (bitRow(B,plane,i)[j>>6] >> (j&63)) & 1;
+}
+
+static inline void bitSet(const bitEnviroment* B, uint64_t* plane, int i, int j, bool v){
+    uint64_t* word = &bitRow(B,plane,i)[j>>6];
+    uint64_t mask = (uint64_t)1 << (j&63);
+    if (v) *word |= mask;
+    else   *word &= ~mask;
+}
+
+#endif
@@ -2,39 +2,33 @@
 #include <time.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <stdatomic.h>
+#include "rng.h"
 //#include <windows.h> função sleep no windows
 
-void setSensation(place* p, place* v){
-
-    if (isNeighbor(*v,*p)){
-        if (v->buraco)
-            p->S.vento = true;
-        if (v->monstro)
-            p->S.cheiro = true;
-    }
-}
-
 /*------------------------------------------------------------------------------
     Funções básicas do ambiente
 ------------------------------------------------------------------------------*/
 
 enviroment newEnviroment(int h, int w){
+/*
+    Aloca o grid inteiro de uma vez, em um bloco contíguo.
+*/
     enviroment E;
     E.h = h; E.w = w;
-    E.grid = malloc(E.h*sizeof(place*));
+    E.grid = malloc((size_t)h*w*sizeof(place));
     if (E.grid!=NULL){
         for (int i=0; i<h; i++){
-            E.grid[i] = malloc(E.w*sizeof(place));
-            if (E.grid[i]!=NULL)
-                for (int j=0; j<w; j++){
-                    E.grid[i][j].buraco = false;
-                    E.grid[i][j].monstro = false;
-                    E.grid[i][j].ouro = false;
-                    E.grid[i][j].S.cheiro = false;
-                    E.grid[i][j].S.vento = false;
-                    E.grid[i][j].row = i;
-                    E.grid[i][j].col = j;
-                }
+            place* row = &E.grid[(size_t)i*w];
+            for (int j=0; j<w; j++){
+                row[j].buraco = false;
+                row[j].monstro = false;
+                row[j].ouro = false;
+                row[j].S.cheiro = false;
+                row[j].S.vento = false;
+                row[j].row = i;
+                row[j].col = j;
+            }
         }
     }
     return E;
@@ -42,71 +36,168 @@ enviroment newEnviroment(int h, int w){
 
 void delEnviroment(enviroment* E){
     if (E!=NULL){
-        for (int i=0; i<E->h; i++){
-            free(E->grid[i]);
-        }
         free(E->grid);
+        E->grid = NULL;
     }
 }
 
-void initEnviroment(enviroment E, int numBuraco, int numMonstro){
+void clearEnviroment(enviroment E){
 /*
-    Inicializa sujeiras no ambiente.
+    Remove buracos, monstros, ouro e sensações, para reutilizar o grid.
 */
-    srand(time(NULL));
-    //Inicializa buracos
-    while (numBuraco>0){
-        int i, j;
-        i = rand()%E.h;
-        j = rand()%E.w;
-        if (i!=0 && i!=E.h-1 && j!=0 && j!=E.w-1){
-            if (!E.grid[i][j].buraco){
-                E.grid[i][j].buraco = true;
-                numBuraco--;
-            }
-        }
+    int n = E.h*E.w;
+    for (int k=0; k<n; k++){
+        E.grid[k].buraco = false;
+        E.grid[k].monstro = false;
+        E.grid[k].ouro = false;
+        E.grid[k].S.cheiro = false;
+        E.grid[k].S.vento = false;
     }
-    //Inicializa monstros
-    while (numMonstro>0){
-        int i, j;
-        i = rand()%E.h;
-        j = rand()%E.w;
-        if (i!=0 && i!=E.h-1 && j!=0 && j!=E.w-1){
-            if (!E.grid[i][j].buraco && !E.grid[i][j].monstro){
-                E.grid[i][j].monstro = true;
-                numMonstro--;
-            }
-        }
+}
+
+uint64_t initEnviroment(enviroment E, int numBuraco, int numMonstro){
+/*
+    Inicializa sujeiras no ambiente. A semente mistura o relógio com um
+    contador, então ambientes criados no mesmo segundo são diferentes; ela é
+    retornada para que a execução possa ser reproduzida com
+    initEnviromentSeed.
+*/
+    static atomic_ullong contador = 0;
+    rngState r = newRng((uint64_t)time(NULL) ^
+        (atomic_fetch_add(&contador,1)*0xd1342543de82ef95ull));
+    uint64_t seed = rngNext(&r);
+    initEnviromentSeed(E,numBuraco,numMonstro,seed);
+    return seed;
+}
+
+/*
+    Tabela de espalhamento mínima usada pelo Fisher-Yates parcial: guarda só
+    as posições da permutação virtual que já foram trocadas.
+*/
+typedef struct{
+    int64_t* chave;
+    int64_t* valor;
+    uint64_t mask;
+} swapTable;
+
+static int64_t* swapSlot(swapTable* T, int64_t k){
+/*
+    Retorna o valor da posição k, inserindo k -> k se ainda não existir.
+*/
+    uint64_t h = ((uint64_t)k*0x9e3779b97f4a7c15ull) & T->mask;
+    while (T->chave[h]!=-1 && T->chave[h]!=k)
+        h = (h+1) & T->mask;
+    if (T->chave[h]==-1){
+        T->chave[h] = k;
+        T->valor[h] = k;
     }
-    //Inicializa ouro
-    bool gold=false;
-    while (!gold){
-        int i, j;
-        i = rand()%E.h;
-        j = rand()%E.w;
-        if (i!=0 && i!=E.h-1 && j!=0 && j!=E.w-1){
-            if (!E.grid[i][j].buraco && !E.grid[i][j].monstro ){
-                E.grid[i][j].ouro = true;
-                gold = true;
-            }
+    return &T->valor[h];
+}
+
+static void stampSensations(enviroment E, place* p){
+/*
+    Carimba vento (cheiro) nos 4 vizinhos de um buraco (monstro).
+*/
+    int i = p->row, j = p->col;
+    if (i>0){
+        place* v = p-E.w;
+        v->S.vento |= p->buraco; v->S.cheiro |= p->monstro;
+    }
+    if (i<E.h-1){
+        place* v = p+E.w;
+        v->S.vento |= p->buraco; v->S.cheiro |= p->monstro;
+    }
+    if (j>0){
+        place* v = p-1;
+        v->S.vento |= p->buraco; v->S.cheiro |= p->monstro;
+    }
+    if (j<E.w-1){
+        place* v = p+1;
+        v->S.vento |= p->buraco; v->S.cheiro |= p->monstro;
+    }
+}
+
+void initEnviromentSeed(enviroment E, int numBuraco, int numMonstro,
+    uint64_t seed){
+/*
+    Como initEnviroment, mas com semente explícita. Sorteia numBuraco +
+    numMonstro + 1 lugares distintos do interior do grid (sem as bordas) por
+    Fisher-Yates parcial, então o tempo é linear no número de objetos, mesmo
+    com densidade alta. Se não couberem todos, são colocados buracos, depois
+    monstros e por último o ouro, até encher o interior.
+    Espera um ambiente limpo (novo ou após clearEnviroment).
+*/
+    int64_t ih = E.h-2, iw = E.w-2;
+    int64_t m = (ih>0 && iw>0) ? ih*iw : 0;
+    if (numBuraco<0) numBuraco = 0;
+    if (numMonstro<0) numMonstro = 0;
+    if (numBuraco>m) numBuraco = m;
+    if (numMonstro>m-numBuraco) numMonstro = m-numBuraco;
+    int64_t k = numBuraco+numMonstro+(m-numBuraco-numMonstro>0 ? 1 : 0);
+    if (k==0)
+        return;
+
+    //Com densidade baixa a permutação virtual fica numa tabela esparsa;
+    //com densidade alta, num vetor denso de m posições
+    swapTable T;
+    int64_t* denso = NULL;
+    T.chave = T.valor = NULL;
+    if (4*k>=m){
+        denso = malloc(m*sizeof(int64_t));
+        if (denso==NULL)
+            return;
+        for (int64_t c=0; c<m; c++) denso[c] = c;
+    } else {
+        uint64_t cap = 1;
+        while (cap<4*(uint64_t)k) cap <<= 1; //no máximo 2 chaves por sorteio
+        T.mask = cap-1;
+        T.chave = malloc(cap*sizeof(int64_t));
+        T.valor = malloc(cap*sizeof(int64_t));
+        if (T.chave==NULL || T.valor==NULL){
+            free(T.chave); free(T.valor);
+            return;
         }
+        for (uint64_t c=0; c<cap; c++) T.chave[c] = -1;
+    }
+
+    rngState r = newRng(seed);
+    for (int64_t t=0; t<k; t++){
+        //Troca a posição t com uma posição sorteada em [t, m)
+        int64_t x = t + (int64_t)rngBounded(&r,m-t);
+        int64_t* px = denso ? &denso[x] : swapSlot(&T,x);
+        int64_t* pt = denso ? &denso[t] : swapSlot(&T,t);
+        int64_t cell = *px;
+        *px = *pt;
+
+        place* p = getPlace(E,1+cell/iw,1+cell%iw);
+        if (t<numBuraco)
+            p->buraco = true;
+        else if (t<numBuraco+numMonstro)
+            p->monstro = true;
+        else
+            p->ouro = true;
+        stampSensations(E,p);
     }
-    initSensations(E);
+    free(denso);
+    free(T.chave); free(T.valor);
 }
 
 void initSensations(enviroment E){
-    //Itera sobre posições no grid
-    for (int i=0; i<E.h; i++)
-        for (int j=0; j<E.w; j++){
-            //Itera sobre vizinhos
-            for (int k=0; k<E.h; k++)
-                for (int l=0; l<E.w; l++){
-                    setSensation(&E.grid[i][j],&E.grid[k][l]);
-                }
-        }
+/*
+    Cada buraco (monstro) carimba vento (cheiro) apenas nos seus 4 vizinhos,
+    em uma única passada pelo grid: O(h*w).
+*/
+    int n = E.h*E.w;
+    for (int k=0; k<n; k++){
+        E.grid[k].S.vento = false;
+        E.grid[k].S.cheiro = false;
+    }
+    for (int k=0; k<n; k++)
+        if (E.grid[k].buraco || E.grid[k].monstro)
+            stampSensations(E,&E.grid[k]);
 }
 
-bool isNeighbor(place p, place q){
+bool isNeighbor(const place* p, const place* q){
 /*
     Considerando vizinhança-4 (em cruz). No exemplo abaixo, as posições marcadas
     como v são vizinhas de o, enquanto aquelas marcadas como u não são.
@@ -114,19 +205,14 @@ bool isNeighbor(place p, place q){
     v o v
     u v u
 */
-    if (p.row==q.row || p.col==q.col){
-        if (p.row==q.row+1 || p.row==q.row-1)
-            return true;
-        if (p.col==q.col+1 || p.col==q.col-1)
-            return true;
-    }
-    return false;
+    int dr = p->row-q->row, dc = p->col-q->col;
+    return (dr==0 && (dc==1 || dc==-1)) || (dc==0 && (dr==1 || dr==-1));
 }
 
 place* getPlace(enviroment E, int i, int j){
 /*
     Retorna ponteiro para place com indices i e j no grid.
 */
-    return &E.grid[i][j];
+    return &E.grid[(size_t)i*E.w+j];
 }
 
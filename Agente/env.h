@@ -1,6 +1,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifndef ENV_H
 #define ENV_H
@@ -19,16 +20,20 @@ typedef struct{
     sensation S; //Sensações que podem ser percebidas pelo agente
 } place;
 
-//O ambiente é uma matriz de lugares (grid)
+//O ambiente é uma matriz de lugares (grid), guardada em um único bloco
+//contíguo linha a linha: o lugar (i,j) fica em grid[i*w+j]
 typedef struct{
     int h, w;
-    place** grid;
+    place* grid;
 } enviroment;
 
 enviroment newEnviroment(int h, int w);
 void delEnviroment(enviroment* E);
-void initEnviroment(enviroment E, int numBuraco, int numMonstro);
-bool isNeighbor(place p, place q);
+void clearEnviroment(enviroment E);
+uint64_t initEnviroment(enviroment E, int numBuraco, int numMonstro);
+void initEnviromentSeed(enviroment E, int numBuraco, int numMonstro,
+    uint64_t seed);
+bool isNeighbor(const place* p, const place* q);
 place* getPlace(enviroment E, int i, int j);
 void initSensations(enviroment E);
 
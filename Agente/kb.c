@@ -0,0 +1,280 @@
+#include "kb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+    Criação
+------------------------------------------------------------------------------*/
+
+kbAgent* newKbAgent(int h, int w){
+    kbAgent* K = malloc(sizeof(kbAgent));
+    if (K==NULL)
+        return NULL;
+    size_t n = (size_t)h*w;
+    K->h = h; K->w = w;
+    K->crenca = malloc(n*sizeof(uint16_t));
+    K->marca = calloc(n,sizeof(unsigned int));
+    K->pai = malloc(n*sizeof(int));
+    K->fila = malloc(n*sizeof(int));
+    K->plano = malloc(n*sizeof(int));
+    K->geracao = 0;
+    if (K->crenca==NULL || K->marca==NULL || K->pai==NULL || K->fila==NULL
+        || K->plano==NULL){
+        delKbAgent(K);
+        return NULL;
+    }
+    resetKbAgent(K);
+    return K;
+}
+
+void delKbAgent(kbAgent* K){
+    if (K!=NULL){
+        free(K->crenca); free(K->marca); free(K->pai);
+        free(K->fila); free(K->plano);
+        free(K);
+    }
+}
+
+void resetKbAgent(kbAgent* K){
+/*
+    Esquece tudo para um novo episódio. O lugar inicial (0,0) é seguro.
+*/
+    memset(K->crenca,0,(size_t)K->h*K->w*sizeof(uint16_t));
+    K->crenca[0] = KB_SEGURO;
+    K->planoLen = K->planoPos = 0;
+    K->alvo = -1;
+}
+
+bool kbSafe(const kbAgent* K, int i, int j){
+    return (K->crenca[(size_t)i*K->w+j] & KB_SEGURO) == KB_SEGURO;
+}
+
+/*------------------------------------------------------------------------------
+    Inferência incremental
+------------------------------------------------------------------------------*/
+
+//Vizinhos-4 de k; retorna quantos
+static int neighbors(const kbAgent* K, int k, int v[4]){
+    int i = k/K->w, j = k%K->w, n = 0;
+    if (i>0)      v[n++] = k-K->w;
+    if (i<K->h-1) v[n++] = k+K->w;
+    if (j>0)      v[n++] = k-1;
+    if (j<K->w-1) v[n++] = k+1;
+    return n;
+}
+
+static void deduce(kbAgent* K, int k, uint16_t sentido, uint16_t sem,
+    uint16_t certo){
+/*
+    Se k foi visitado e percebeu 'sentido', e só resta um vizinho que não
+    está livre do perigo, o perigo está nele.
+*/
+    if (!(K->crenca[k] & KB_VISITADO) || !(K->crenca[k] & sentido))
+        return;
+    int v[4], n = neighbors(K,k,v), unico = -1, resta = 0;
+    for (int t=0; t<n; t++)
+        if (!(K->crenca[v[t]] & sem)){
+            resta++;
+            unico = v[t];
+        }
+    if (resta==1)
+        K->crenca[unico] |= certo;
+}
+
+static void markFree(kbAgent* K, int k, uint16_t sem, uint16_t talvez,
+    uint16_t certo, uint16_t sentido){
+/*
+    Marca k como livre de um perigo e revê as deduções dos vizinhos
+    visitados que perceberam esse perigo (só a vizinhança é afetada).
+*/
+    if (K->crenca[k] & sem)
+        return;
+    K->crenca[k] |= sem;
+    K->crenca[k] &= ~(talvez | certo);
+    int v[4], n = neighbors(K,k,v);
+    for (int t=0; t<n; t++)
+        deduce(K,v[t],sentido,sem,certo);
+}
+
+static void senseHazard(kbAgent* K, int k, bool percebeu, uint16_t sentido,
+    uint16_t sem, uint16_t talvez, uint16_t certo){
+    int v[4], n = neighbors(K,k,v);
+    if (!percebeu){
+        for (int t=0; t<n; t++)
+            markFree(K,v[t],sem,talvez,certo,sentido);
+        return;
+    }
+    K->crenca[k] |= sentido;
+    for (int t=0; t<n; t++)
+        if (!(K->crenca[v[t]] & sem))
+            K->crenca[v[t]] |= talvez;
+    deduce(K,k,sentido,sem,certo);
+}
+
+void kbObserve(kbAgent* K, const observation* obs){
+/*
+    Incorpora a percepção do lugar atual. Estar vivo aqui prova que o lugar
+    é seguro (um monstro aqui teria sido morto pela flecha).
+*/
+    int k = obs->row*K->w + obs->col;
+    K->crenca[k] |= KB_VISITADO;
+    markFree(K,k,KB_SEM_BURACO,KB_TALVEZ_BURACO,KB_BURACO,KB_VENTO);
+    markFree(K,k,KB_SEM_MONSTRO,KB_TALVEZ_MONSTRO,KB_MONSTRO,KB_CHEIRO);
+    senseHazard(K,k,obs->S.vento,KB_VENTO,KB_SEM_BURACO,KB_TALVEZ_BURACO,
+        KB_BURACO);
+    senseHazard(K,k,obs->S.cheiro,KB_CHEIRO,KB_SEM_MONSTRO,KB_TALVEZ_MONSTRO,
+        KB_MONSTRO);
+}
+
+/*------------------------------------------------------------------------------
+    Planejamento
+------------------------------------------------------------------------------*/
+
+typedef enum{
+    ALVO_SAIDA,         //a saída (h-1,w-1)
+    ALVO_SEGURO,        //lugar seguro ainda não visitado
+    ALVO_MONSTRO,       //sem buraco, mas talvez (ou com certeza) monstro
+    ALVO_DESCONHECIDO,  //não visitado e sem buraco deduzido
+    ALVO_QUALQUER       //qualquer lugar não visitado
+} tipoAlvo;
+
+static bool isGoal(const kbAgent* K, int k, tipoAlvo tipo){
+    uint16_t c = K->crenca[k];
+    switch (tipo){
+        case ALVO_SAIDA:        return k==K->h*K->w-1;
+        case ALVO_SEGURO:       return (c & KB_SEGURO)==KB_SEGURO && !(c & KB_VISITADO);
+        case ALVO_MONSTRO:      return (c & KB_SEM_BURACO) && !(c & KB_SEM_MONSTRO);
+        case ALVO_DESCONHECIDO: return !(c & KB_VISITADO) && !(c & KB_BURACO);
+        case ALVO_QUALQUER:     return !(c & KB_VISITADO);
+    }
+    return false;
+}
+
+static bool plan(kbAgent* K, int origem, tipoAlvo tipo){
+/*
+    Busca em largura a partir da origem, andando só por lugares seguros, até
+    o alvo mais próximo do tipo pedido (que pode não ser seguro). Marca,
+    pai e fila são reutilizados entre chamadas: trocar de geração equivale a
+    limpar as marcas, sem percorrer o grid.
+*/
+    if (++K->geracao==0){
+        memset(K->marca,0,(size_t)K->h*K->w*sizeof(unsigned int));
+        K->geracao = 1;
+    }
+    int ini = 0, fim = 0;
+    K->fila[fim++] = origem;
+    K->marca[origem] = K->geracao;
+    K->pai[origem] = -1;
+    while (ini<fim){
+        int u = K->fila[ini++];
+        if (u!=origem && isGoal(K,u,tipo)){
+            //Reconstrói o plano de trás para frente
+            int len = 0;
+            for (int x=u; x!=origem; x=K->pai[x]) len++;
+            K->planoLen = len;
+            K->planoPos = 0;
+            for (int x=u; x!=origem; x=K->pai[x]) K->plano[--len] = x;
+            K->alvo = u;
+            return true;
+        }
+        if (u!=origem && (K->crenca[u] & KB_SEGURO)!=KB_SEGURO)
+            continue; //só atravessa lugares seguros
+        int v[4], n = neighbors(K,u,v);
+        for (int t=0; t<n; t++)
+            if (K->marca[v[t]]!=K->geracao){
+                K->marca[v[t]] = K->geracao;
+                K->pai[v[t]] = u;
+                K->fila[fim++] = v[t];
+            }
+    }
+    return false;
+}
+
+static bool planValid(const kbAgent* K, const observation* obs){
+/*
+    O plano continua valendo se o alvo ainda interessa e o próximo passo é
+    vizinho do lugar atual.
+*/
+    if (K->planoPos>=K->planoLen)
+        return false;
+    int alvo = K->alvo;
+    if (obs->comOuro && alvo!=K->h*K->w-1)
+        return false;
+    if (!obs->comOuro && (K->crenca[alvo] & KB_VISITADO))
+        return false;
+    if (K->crenca[alvo] & KB_BURACO)
+        return false;
+    int prox = K->plano[K->planoPos];
+    int pi = prox/K->w, pj = prox%K->w;
+    int di = pi-obs->row, dj = pj-obs->col;
+    return (di==0 && (dj==1 || dj==-1)) || (dj==0 && (di==1 || di==-1));
+}
+
+acao kbDecide(kbAgent* K, const observation* obs, unsigned int* rng){
+/*
+    Atualiza a crença e escolhe a próxima ação. Com o ouro, volta para a
+    saída; sem ele, explora o lugar seguro mais próximo e, só quando não
+    houver nenhum, arrisca em ordem crescente de perigo.
+*/
+    kbObserve(K,obs);
+    int origem = obs->row*K->w + obs->col;
+
+    if (!planValid(K,obs)){
+        bool ok = false;
+        if (obs->comOuro)
+            ok = plan(K,origem,ALVO_SAIDA);
+        else{
+            ok = plan(K,origem,ALVO_SEGURO);
+            if (!ok && obs->temFlecha)
+                ok = plan(K,origem,ALVO_MONSTRO);
+            if (!ok)
+                ok = plan(K,origem,ALVO_DESCONHECIDO);
+            if (!ok)
+                ok = plan(K,origem,ALVO_QUALQUER);
+        }
+        if (!ok){
+            unsigned int x = *rng;
+            x ^= x<<13; x ^= x>>17; x ^= x<<5;
+            *rng = x;
+            return (acao)(x>>30);
+        }
+    }
+
+    int prox = K->plano[K->planoPos++];
+    int pi = prox/K->w, pj = prox%K->w;
+    if (pi>obs->row) return ACAO_BAIXO;
+    if (pi<obs->row) return ACAO_CIMA;
+    if (pj>obs->col) return ACAO_DIREITA;
+    return ACAO_ESQUERDA;
+}
+
+/*------------------------------------------------------------------------------
+    Política para o simulador
+------------------------------------------------------------------------------*/
+
+static void* kbCreate(int h, int w, void* arg){
+    (void)arg;
+    return newKbAgent(h,w);
+}
+
+static void kbReset(void* state){
+    resetKbAgent(state);
+}
+
+static acao kbDecidePolicy(void* state, const observation* obs, unsigned int* rng){
+    return kbDecide(state,obs,rng);
+}
+
+static void kbDestroy(void* state){
+    delKbAgent(state);
+}
+
+policy kbPolicy(void){
+    policy P;
+    P.create = kbCreate;
+    P.reset = kbReset;
+    P.decide = kbDecidePolicy;
+    P.destroy = kbDestroy;
+    P.arg = NULL;
+    return P;
+}
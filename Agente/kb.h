@@ -0,0 +1,53 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+#ifndef KB_H
+#define KB_H
+
+/*
+    Agente autônomo com base de conhecimento. Mantém uma crença por lugar,
+    atualizada só na vizinhança do lugar observado a cada passo, e planeja
+    por busca em largura sobre os lugares sabidamente seguros.
+*/
+
+//Bits de crença de cada lugar
+#define KB_VISITADO       1
+#define KB_SEM_BURACO     2     //sabidamente sem buraco
+#define KB_SEM_MONSTRO    4     //sabidamente sem monstro
+#define KB_TALVEZ_BURACO  8
+#define KB_TALVEZ_MONSTRO 16
+#define KB_BURACO         32    //buraco deduzido
+#define KB_MONSTRO        64    //monstro deduzido
+#define KB_VENTO          128   //vento percebido aqui
+#define KB_CHEIRO         256   //cheiro percebido aqui
+#define KB_SEGURO (KB_SEM_BURACO | KB_SEM_MONSTRO)
+
+typedef struct{
+    int h, w;
+    uint16_t* crenca;       //h*w bits de crença
+
+    //Busca reutilizável: marca[k]==geracao indica lugar já visto nesta busca
+    unsigned int* marca;
+    unsigned int geracao;
+    int* pai;
+    int* fila;
+
+    //Plano atual (sequência de lugares a percorrer)
+    int* plano;
+    int planoLen, planoPos;
+    int alvo;
+} kbAgent;
+
+kbAgent* newKbAgent(int h, int w);
+void delKbAgent(kbAgent* K);
+void resetKbAgent(kbAgent* K);
+void kbObserve(kbAgent* K, const observation* obs);
+acao kbDecide(kbAgent* K, const observation* obs, unsigned int* rng);
+
+bool kbSafe(const kbAgent* K, int i, int j);
+
+//Política para o simulador (sim.h)
+policy kbPolicy(void);
+
+#endif
@@ -19,30 +19,30 @@ int main(){
     printf("Você começa na posição (0,0). Boa sorte! \n");
 
     char mov;
-    while(!(A.comOuro && A.onde->row==E.h-1 && A.onde->col==E.w-1)){
+    while(!(A.comOuro && A.row==E.h-1 && A.col==E.w-1)){
         printf("Score atual: %d \n", A.score);
         printSimulation(A,E);
-        sense(A);
+        sense(A,E);
         printf("Para onde você deseja se mover? \n");
         scanf(" %c",&mov);
         if (mov=='b'){
-            if (A.onde->row<E.h-1){
-                move(&A,E,&E.grid[A.onde->row+1][A.onde->col]);
+            if (A.row<E.h-1){
+                move(&A,E,getPlace(E,A.row+1,A.col));
             }
         }
         if (mov=='c'){
-            if (A.onde->row>0){
-                move(&A,E,&E.grid[A.onde->row-1][A.onde->col]);
+            if (A.row>0){
+                move(&A,E,getPlace(E,A.row-1,A.col));
             }
         }
         if (mov=='d'){
-            if (A.onde->col<E.w-1){
-                move(&A,E,&E.grid[A.onde->row][A.onde->col+1]);
+            if (A.col<E.w-1){
+                move(&A,E,getPlace(E,A.row,A.col+1));
             }
         }
         if (mov=='e'){
-            if (A.onde->col>0){
-                move(&A,E,&E.grid[A.onde->row][A.onde->col-1]);
+            if (A.col>0){
+                move(&A,E,getPlace(E,A.row,A.col-1));
             }
         }
     }
@@ -0,0 +1,544 @@
+#include "mcts.h"
+#include "rng.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/*------------------------------------------------------------------------------
+    Criação
+------------------------------------------------------------------------------*/
+
+mctsConfig defaultMctsConfig(void){
+    mctsConfig C;
+    C.tempo = 0.01;
+    C.maxIteracoes = 0;
+    C.threads = 0;
+    C.maxNos = 1<<18;
+    C.profundidade = 200;
+    C.exploracao = 100.0;
+    C.pBuraco = 0.1;
+    C.pMonstro = 0.05;
+    C.seed = 1;
+    return C;
+}
+
+//Área de cada thread da busca, alocada uma vez por solver
+struct mctsWorker{
+    mctsSolver* M;
+    int indice;                 //0: thread que chama mctsDecide
+    pthread_t th;
+    int* caminho;               //nós visitados na seleção
+    int* mortos;                //monstros mortos na simulação
+};
+
+#define MAX_CAMINHO 4096
+
+static void* poolThread(void* arg);
+
+static void freeSolverMemory(mctsSolver* M){
+    if (M->workers!=NULL)
+        for (int t=0; t<M->C.threads; t++){
+            free(M->workers[t].caminho);
+            free(M->workers[t].mortos);
+        }
+    free(M->workers);
+    free(M->nos);
+    free(M);
+}
+
+mctsSolver* newMctsSolver(mctsConfig C){
+/*
+    Aloca o pool de nós e as áreas de cada thread e cria as threads do pool,
+    que dormem até a primeira decisão. Se alguma thread não puder ser
+    criada, o solver segue só com as que já existem.
+*/
+    mctsSolver* M = calloc(1,sizeof(mctsSolver));
+    if (M==NULL)
+        return NULL;
+    if (C.threads<=0){
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        C.threads = n>0 ? (int)n : 1;
+    }
+    if (C.maxNos<2) C.maxNos = 2;
+    M->C = C;
+    M->nos = malloc((size_t)C.maxNos*sizeof(mctsNode));
+    M->workers = calloc(C.threads,sizeof(struct mctsWorker));
+    if (M->nos==NULL || M->workers==NULL){
+        freeSolverMemory(M);
+        return NULL;
+    }
+    for (int t=0; t<C.threads; t++){
+        struct mctsWorker* W = &M->workers[t];
+        W->M = M;
+        W->indice = t;
+        W->caminho = malloc(MAX_CAMINHO*sizeof(int));
+        W->mortos = malloc((MAX_CAMINHO+(size_t)C.profundidade+1)*sizeof(int));
+        if (W->caminho==NULL || W->mortos==NULL){
+            freeSolverMemory(M);
+            return NULL;
+        }
+    }
+    int em = pthread_mutex_init(&M->m,NULL);
+    int ea = pthread_cond_init(&M->acorda,NULL);
+    int ep = pthread_cond_init(&M->pronto,NULL);
+    if (em!=0 || ea!=0 || ep!=0){
+        if (em==0) pthread_mutex_destroy(&M->m);
+        if (ea==0) pthread_cond_destroy(&M->acorda);
+        if (ep==0) pthread_cond_destroy(&M->pronto);
+        freeSolverMemory(M);
+        return NULL;
+    }
+    M->numWorkers = 1;
+    while (M->numWorkers<C.threads
+        && pthread_create(&M->workers[M->numWorkers].th,NULL,poolThread,
+            &M->workers[M->numWorkers])==0)
+        M->numWorkers++;
+    return M;
+}
+
+void delMctsSolver(mctsSolver* M){
+    if (M!=NULL){
+        pthread_mutex_lock(&M->m);
+        M->sair = true;
+        pthread_cond_broadcast(&M->acorda);
+        pthread_mutex_unlock(&M->m);
+        for (int t=1; t<M->numWorkers; t++)
+            pthread_join(M->workers[t].th,NULL);
+        pthread_mutex_destroy(&M->m);
+        pthread_cond_destroy(&M->acorda);
+        pthread_cond_destroy(&M->pronto);
+        freeSolverMemory(M);
+    }
+}
+
+static void resetNode(mctsNode* n){
+    for (int a=0; a<4; a++) atomic_store_explicit(&n->filho[a],0,memory_order_relaxed);
+    atomic_store_explicit(&n->visitas,0,memory_order_relaxed);
+    atomic_store_explicit(&n->soma,0,memory_order_relaxed);
+}
+
+/*------------------------------------------------------------------------------
+    Mundo determinizado
+------------------------------------------------------------------------------*/
+
+//Estado de uma simulação: só o que muda; o grid é sorteado sob demanda
+typedef struct{
+    agent A;
+    bool terminal;
+    int ouro;                   //lugar do ouro neste mundo (-1: nenhum)
+    uint64_t seed;              //semente do mundo desta iteração
+    int* mortos;                //monstros mortos nesta simulação
+    int numMortos;
+} simState;
+
+typedef struct{
+    mctsSolver* M;
+    const kbAgent* K;
+    const observation* obs;
+    uint64_t limBuraco, limMonstro;
+    double fim;                 //instante limite (CLOCK_MONOTONIC)
+    atomic_llong iteracoes;
+} mctsCtx;
+
+static double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static uint64_t mix(uint64_t seed, uint64_t k){
+    rngState r = newRng(seed ^ (k*0xd1342543de82ef95ull));
+    return rngNext(&r);
+}
+
+static uint64_t probLimit(double p){
+/*
+    Limiar para sortear com probabilidade p comparando com um uint64_t
+    uniforme. p é limitada a [0,1]; 1.0 vira UINT64_MAX explicitamente,
+    pois 2^64 não cabe em um uint64_t.
+*/
+    if (!(p>0.0))
+        return 0;
+    if (p>=1.0)
+        return UINT64_MAX;
+    return (uint64_t)(p*18446744073709551616.0);
+}
+
+static place sampleCell(const mctsCtx* X, const simState* s, int i, int j){
+/*
+    Sorteia o conteúdo de (i,j) no mundo da iteração, de forma determinística
+    para a mesma semente. O que a crença sabe é respeitado; o resto segue as
+    densidades a priori. Assim como em initEnviroment, a borda nunca tem
+    perigos nem ouro.
+*/
+    const kbAgent* K = X->K;
+    int k = i*K->w + j;
+    uint16_t c = K->crenca[k];
+    place p;
+    memset(&p,0,sizeof(p));
+    p.row = i; p.col = j;
+    p.ouro = (k==s->ouro);
+    if (i==0 || j==0 || i==K->h-1 || j==K->w-1)
+        return p;
+    if (c & KB_BURACO)
+        p.buraco = true;
+    else if (!(c & KB_SEM_BURACO))
+        p.buraco = mix(s->seed,2*(uint64_t)k) < X->limBuraco;
+    if (p.buraco)
+        return p;
+    if (c & KB_MONSTRO)
+        p.monstro = true;
+    else if (!(c & KB_SEM_MONSTRO))
+        p.monstro = mix(s->seed,2*(uint64_t)k+1) < X->limMonstro;
+    if (p.monstro)
+        for (int m=0; m<s->numMortos; m++)
+            if (s->mortos[m]==k){
+                p.monstro = false;
+                break;
+            }
+    return p;
+}
+
+static bool apply(const mctsCtx* X, simState* s, acao a){
+/*
+    Aplica a ação com as regras de stepPlace. Retorna falso se a ação
+    sairia do grid.
+*/
+    int i = s->A.row, j = s->A.col;
+    switch (a){
+        case ACAO_BAIXO:    i++; break;
+        case ACAO_CIMA:     i--; break;
+        case ACAO_DIREITA:  j++; break;
+        case ACAO_ESQUERDA: j--; break;
+    }
+    if (i<0 || i>=X->K->h || j<0 || j>=X->K->w)
+        return false;
+    place p = sampleCell(X,s,i,j);
+    int ev = stepPlace(&s->A,X->K->h,X->K->w,&p);
+    if (ev & EV_MATOU)
+        s->mortos[s->numMortos++] = i*X->K->w + j;
+    if (ev & (EV_BURACO | EV_PEGO | EV_ESCAPOU))
+        s->terminal = true;
+    return true;
+}
+
+static long long finalValue(const mctsCtx* X, const simState* s){
+/*
+    Retorno da simulação: score acumulado, menos a estimativa de passos que
+    ainda faltariam se a simulação foi cortada antes do fim.
+*/
+    if (s->terminal)
+        return s->A.score;
+    int h = X->K->h, w = X->K->w;
+    int resta;
+    if (s->A.comOuro || s->ouro<0)
+        resta = (h-1-s->A.row) + (w-1-s->A.col);
+    else{
+        int oi = s->ouro/w, oj = s->ouro%w;
+        resta = abs(oi-s->A.row) + abs(oj-s->A.col) + (h-1-oi) + (w-1-oj);
+    }
+    return (long long)s->A.score - resta;
+}
+
+static acao rolloutAction(const mctsCtx* X, const simState* s, rngState* r){
+/*
+    Política das simulações: na maior parte das vezes anda em direção ao
+    objetivo atual (ouro ou saída), senão ao acaso; evita buracos deduzidos.
+*/
+    const kbAgent* K = X->K;
+    int ti, tj;
+    if (s->A.comOuro || s->ouro<0){ ti = K->h-1; tj = K->w-1; }
+    else{ ti = s->ouro/K->w; tj = s->ouro%K->w; }
+    for (int tent=0; tent<4; tent++){
+        acao a;
+        uint64_t x = rngNext(r);
+        if ((x & 3)!=0){
+            bool vertical = (x>>2) & 1;
+            if (ti==s->A.row) vertical = false;
+            if (tj==s->A.col) vertical = true;
+            if (vertical) a = ti>s->A.row ? ACAO_BAIXO : ACAO_CIMA;
+            else          a = tj>s->A.col ? ACAO_DIREITA : ACAO_ESQUERDA;
+        } else {
+            a = (acao)((x>>8) & 3);
+        }
+        int i = s->A.row + (a==ACAO_BAIXO) - (a==ACAO_CIMA);
+        int j = s->A.col + (a==ACAO_DIREITA) - (a==ACAO_ESQUERDA);
+        if (i<0 || i>=K->h || j<0 || j>=K->w)
+            continue;
+        if (K->crenca[i*K->w+j] & KB_BURACO)
+            continue;
+        return a;
+    }
+    return (acao)(rngNext(r) & 3);
+}
+
+/*------------------------------------------------------------------------------
+    Busca
+------------------------------------------------------------------------------*/
+
+#define PERDA_VIRTUAL 1000
+
+static int childFor(mctsSolver* M, mctsNode* n, int a){
+/*
+    Retorna o filho a de n, criando-o se preciso. Se duas threads criam o
+    mesmo filho, o CAS decide e o nó perdedor é descartado.
+*/
+    int c = atomic_load_explicit(&n->filho[a],memory_order_acquire);
+    if (c!=0)
+        return c;
+    int novo = atomic_fetch_add(&M->usados,1);
+    if (novo>=M->C.maxNos)
+        return 0;
+    resetNode(&M->nos[novo]);
+    int esperado = 0;
+    if (atomic_compare_exchange_strong(&n->filho[a],&esperado,novo))
+        return novo;
+    return esperado;
+}
+
+static acao selectChild(const mctsCtx* X, const simState* s, mctsNode* n){
+/*
+    UCT: filhos nunca visitados primeiro, depois maior média + exploração.
+*/
+    double lnN = log((double)atomic_load_explicit(&n->visitas,memory_order_relaxed)+1.0);
+    double melhor = -INFINITY;
+    acao escolha = ACAO_BAIXO;
+    for (int a=0; a<4; a++){
+        int i = s->A.row + (a==ACAO_BAIXO) - (a==ACAO_CIMA);
+        int j = s->A.col + (a==ACAO_DIREITA) - (a==ACAO_ESQUERDA);
+        if (i<0 || i>=X->K->h || j<0 || j>=X->K->w)
+            continue;
+        int c = atomic_load_explicit(&n->filho[a],memory_order_acquire);
+        double v;
+        if (c==0)
+            v = INFINITY;
+        else{
+            mctsNode* f = &X->M->nos[c];
+            int nv = atomic_load_explicit(&f->visitas,memory_order_relaxed);
+            if (nv==0)
+                v = INFINITY;
+            else{
+                double media = (double)atomic_load_explicit(&f->soma,memory_order_relaxed)/nv;
+                v = media + X->M->C.exploracao*sqrt(lnN/nv);
+            }
+        }
+        if (v>melhor){
+            melhor = v;
+            escolha = (acao)a;
+        }
+    }
+    return escolha;
+}
+
+static void search(mctsCtx* X, struct mctsWorker* W){
+/*
+    Iterações de uma thread. A semente depende só de C.seed, do número da
+    decisão e do índice da thread, então com uma thread e maxIteracoes a
+    busca é reprodutível.
+*/
+    mctsSolver* M = X->M;
+    const kbAgent* K = X->K;
+    const observation* obs = X->obs;
+    const int maxCaminho = MAX_CAMINHO;
+    int* caminho = W->caminho;
+    int* mortos = W->mortos;
+    rngState r = newRng(mix(M->C.seed ^ (M->decisoes*0x9e3779b97f4a7c15ull),
+        (uint64_t)W->indice));
+
+    for (long long local=0; ; local++){
+        long long it = atomic_fetch_add(&X->iteracoes,1);
+        if (M->C.maxIteracoes>0 && it>=M->C.maxIteracoes)
+            break;
+        if ((local & 31)==0 && now()>=X->fim)
+            break;
+
+        //Sorteia o mundo da iteração
+        simState s;
+        s.A.row = obs->row; s.A.col = obs->col;
+        s.A.comOuro = obs->comOuro; s.A.temFlecha = obs->temFlecha;
+        s.A.score = 0;
+        s.terminal = false;
+        s.seed = rngNext(&r);
+        s.mortos = mortos;
+        s.numMortos = 0;
+        s.ouro = -1;
+        if (!obs->comOuro && K->h>2 && K->w>2)
+            for (int tent=0; tent<8; tent++){
+                int oi = 1 + rngBounded(&r,K->h-2), oj = 1 + rngBounded(&r,K->w-2);
+                int k = oi*K->w + oj;
+                if (!(K->crenca[k] & (KB_VISITADO | KB_BURACO))){
+                    s.ouro = k;
+                    break;
+                }
+            }
+
+        //Seleção e expansão, com perda virtual no caminho
+        int len = 0, atual = 0;
+        caminho[len++] = 0;
+        atomic_fetch_add(&M->nos[0].visitas,1);
+        while (!s.terminal && len<maxCaminho){
+            mctsNode* n = &M->nos[atual];
+            acao a = selectChild(X,&s,n);
+            int f = childFor(M,n,a);
+            apply(X,&s,a);
+            if (f==0)
+                break; //pool cheio: segue só com a simulação
+            atomic_fetch_add(&M->nos[f].visitas,1);
+            atomic_fetch_sub(&M->nos[f].soma,PERDA_VIRTUAL);
+            caminho[len++] = f;
+            atual = f;
+            if (atomic_load_explicit(&M->nos[f].visitas,memory_order_relaxed)==1)
+                break; //nó novo: expande um por iteração
+        }
+
+        //Simulação
+        for (int d=0; d<M->C.profundidade && !s.terminal; d++)
+            apply(X,&s,rolloutAction(X,&s,&r));
+        long long v = finalValue(X,&s);
+
+        //Retropropagação, desfazendo a perda virtual
+        atomic_fetch_add(&M->nos[0].soma,v);
+        for (int p=1; p<len; p++)
+            atomic_fetch_add(&M->nos[caminho[p]].soma,v+PERDA_VIRTUAL);
+    }
+}
+
+static void* poolThread(void* arg){
+/*
+    Dorme até a próxima rodada (ou até o solver ser destruído), busca com
+    o contexto da decisão em andamento e avisa quando termina.
+*/
+    struct mctsWorker* W = arg;
+    mctsSolver* M = W->M;
+    uint64_t vista = 0;
+    pthread_mutex_lock(&M->m);
+    for (;;){
+        while (!M->sair && M->rodada==vista)
+            pthread_cond_wait(&M->acorda,&M->m);
+        if (M->sair)
+            break;
+        vista = M->rodada;
+        mctsCtx* X = M->ctx;
+        pthread_mutex_unlock(&M->m);
+        search(X,W);
+        pthread_mutex_lock(&M->m);
+        if (--M->ativos==0)
+            pthread_cond_signal(&M->pronto);
+    }
+    pthread_mutex_unlock(&M->m);
+    return NULL;
+}
+
+acao mctsDecide(mctsSolver* M, const kbAgent* K, const observation* obs,
+    mctsStats* S){
+/*
+    Busca a partir da posição atual até esgotar o tempo (ou as iterações)
+    e escolhe a ação mais visitada. A árvore é descartada a cada decisão,
+    mas o pool de nós e as threads são reutilizados.
+*/
+    double ini = now();
+    mctsCtx X;
+    X.M = M; X.K = K; X.obs = obs;
+    X.limBuraco = probLimit(M->C.pBuraco);
+    X.limMonstro = probLimit(M->C.pMonstro);
+    X.fim = ini + M->C.tempo;
+    atomic_init(&X.iteracoes,0);
+    atomic_store(&M->usados,1);
+    resetNode(&M->nos[0]);
+    M->decisoes++;
+
+    //Acorda o pool, busca também nesta thread e espera as demais
+    pthread_mutex_lock(&M->m);
+    M->ctx = &X;
+    M->ativos = M->numWorkers-1;
+    M->rodada++;
+    pthread_cond_broadcast(&M->acorda);
+    pthread_mutex_unlock(&M->m);
+    search(&X,&M->workers[0]);
+    pthread_mutex_lock(&M->m);
+    while (M->ativos>0)
+        pthread_cond_wait(&M->pronto,&M->m);
+    M->ctx = NULL;
+    pthread_mutex_unlock(&M->m);
+
+    acao melhor = ACAO_BAIXO;
+    int maisVisitas = -1;
+    for (int a=0; a<4; a++){
+        int c = atomic_load(&M->nos[0].filho[a]);
+        int nv = c ? atomic_load(&M->nos[c].visitas) : 0;
+        if (S!=NULL){
+            S->visitas[a] = nv;
+            S->media[a] = nv ? (double)atomic_load(&M->nos[c].soma)/nv : 0.0;
+        }
+        if (c && nv>maisVisitas){
+            maisVisitas = nv;
+            melhor = (acao)a;
+        }
+    }
+    if (S!=NULL){
+        long long it = atomic_load(&X.iteracoes);
+        if (M->C.maxIteracoes>0 && it>M->C.maxIteracoes) it = M->C.maxIteracoes;
+        S->iteracoes = it;
+        int usados = atomic_load(&M->usados);
+        S->nos = usados<M->C.maxNos ? usados : M->C.maxNos;
+        S->segundos = now()-ini;
+    }
+    return melhor;
+}
+
+/*------------------------------------------------------------------------------
+    Política para o simulador
+------------------------------------------------------------------------------*/
+
+typedef struct{
+    kbAgent* K;
+    mctsSolver* M;
+} mctsPolicyState;
+
+static void* mctsCreate(int h, int w, void* arg){
+    mctsPolicyState* P = malloc(sizeof(mctsPolicyState));
+    if (P==NULL)
+        return NULL;
+    //O simulador já usa uma thread por episódio
+    mctsConfig C = *(mctsConfig*)arg;
+    if (C.threads<=0) C.threads = 1;
+    P->K = newKbAgent(h,w);
+    P->M = P->K!=NULL ? newMctsSolver(C) : NULL;
+    if (P->M==NULL){
+        delKbAgent(P->K);
+        free(P);
+        return NULL;
+    }
+    return P;
+}
+
+static void mctsReset(void* state){
+    resetKbAgent(((mctsPolicyState*)state)->K);
+}
+
+static acao mctsDecidePolicy(void* state, const observation* obs, unsigned int* rng){
+    (void)rng;
+    mctsPolicyState* P = state;
+    kbObserve(P->K,obs);
+    return mctsDecide(P->M,P->K,obs,NULL);
+}
+
+static void mctsDestroy(void* state){
+    mctsPolicyState* P = state;
+    delKbAgent(P->K);
+    delMctsSolver(P->M);
+    free(P);
+}
+
+policy mctsPolicy(mctsConfig* C){
+    policy P;
+    P.create = mctsCreate;
+    P.reset = mctsReset;
+    P.decide = mctsDecidePolicy;
+    P.destroy = mctsDestroy;
+    P.arg = C;
+    return P;
+}
@@ -0,0 +1,79 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "kb.h"
+
+#ifndef MCTS_H
+#define MCTS_H
+
+/*
+    Solver por busca em árvore Monte Carlo (MCTS/UCT) sobre o estado de
+    crença do agente (kbAgent). Cada iteração sorteia um mundo compatível com
+    a crença (determinização) e simula nele as regras de stepPlace: -1 por
+    passo, -10 ao matar o monstro e -1000 ao morrer. Simulações cortadas pelo
+    limite de profundidade são completadas pela distância de Manhattan até o
+    ouro e dele até a saída.
+
+    A árvore é compartilhada entre as threads (paralelismo em árvore): as
+    estatísticas dos nós são atômicas, os nós vêm de um pool pré-alocado e
+    a perda virtual espalha as threads por ramos diferentes. As threads são
+    criadas uma vez por solver e acordadas a cada decisão.
+*/
+
+typedef struct{
+    double tempo;               //orçamento por decisão, em segundos
+    long long maxIteracoes;     //0: sem limite além do tempo
+    int threads;                //<= 0: número de núcleos (1 em mctsPolicy)
+    int maxNos;                 //capacidade do pool de nós
+    int profundidade;           //limite de passos de cada simulação
+    double exploracao;          //constante do UCT, na escala do score
+    double pBuraco, pMonstro;   //densidade a priori nos lugares desconhecidos
+    uint64_t seed;
+} mctsConfig;
+
+typedef struct{
+    atomic_int filho[4];        //0: filho ainda não criado
+    atomic_int visitas;
+    atomic_llong soma;          //soma dos retornos (scores são inteiros)
+} mctsNode;
+
+struct mctsWorker;
+
+typedef struct{
+    mctsConfig C;
+    mctsNode* nos;
+    atomic_int usados;
+    uint64_t decisoes;
+
+    //Pool de threads: workers[0] é a thread que chama mctsDecide
+    struct mctsWorker* workers;
+    int numWorkers;             //threads do pool efetivamente criadas
+    pthread_mutex_t m;
+    pthread_cond_t acorda, pronto;
+    uint64_t rodada;            //incrementada a cada decisão
+    int ativos;                 //threads do pool ainda na rodada atual
+    bool sair;
+    void* ctx;                  //contexto da decisão em andamento
+} mctsSolver;
+
+typedef struct{
+    long long iteracoes;
+    int nos;
+    double segundos;
+    int visitas[4];
+    double media[4];
+} mctsStats;
+
+mctsConfig defaultMctsConfig(void);
+mctsSolver* newMctsSolver(mctsConfig C);
+void delMctsSolver(mctsSolver* M);
+acao mctsDecide(mctsSolver* M, const kbAgent* K, const observation* obs,
+    mctsStats* S);
+
+//Política para o simulador: kbAgent para a crença e MCTS para decidir.
+//O mctsConfig apontado precisa viver enquanto a política for usada. Como o
+//simulador já roda um episódio por thread, threads <= 0 vira 1 aqui.
+policy mctsPolicy(mctsConfig* C);
+
+#endif
@@ -0,0 +1,376 @@
+#include "path.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+    Criação e obstáculos
+------------------------------------------------------------------------------*/
+
+pathFinder* newPathFinder(int h, int w){
+    pathFinder* F = malloc(sizeof(pathFinder));
+    if (F==NULL)
+        return NULL;
+    size_t n = (size_t)h*w;
+    F->h = h; F->w = w;
+    F->bloqueado = calloc(n,1);
+    F->marca = calloc(n,sizeof(unsigned int));
+    F->g = malloc(n*sizeof(int));
+    F->pai = malloc(n*sizeof(int));
+    F->heapCap = 1024;
+    F->heap = malloc(F->heapCap*sizeof(heapItem));
+    F->heapLen = 0;
+    F->base = 0;
+    F->expandidos = 0;
+    F->salto[0] = F->salto[1] = NULL;
+    F->saltosProntos = false;
+    if (F->bloqueado==NULL || F->marca==NULL || F->g==NULL || F->pai==NULL
+        || F->heap==NULL){
+        delPathFinder(F);
+        return NULL;
+    }
+    return F;
+}
+
+void delPathFinder(pathFinder* F){
+    if (F!=NULL){
+        free(F->bloqueado); free(F->marca); free(F->g);
+        free(F->pai); free(F->heap);
+        free(F->salto[0]); free(F->salto[1]);
+        free(F);
+    }
+}
+
+void pathFinderSync(pathFinder* F, enviroment E){
+/*
+    Copia os obstáculos do ambiente (buracos e monstros vivos).
+*/
+    size_t n = (size_t)F->h*F->w;
+    for (size_t k=0; k<n; k++)
+        F->bloqueado[k] = E.grid[k].buraco || E.grid[k].monstro;
+    F->saltosProntos = false;
+}
+
+static void updateJumpColumn(pathFinder* F, int j);
+
+void pathFinderSetBlocked(pathFinder* F, int i, int j, bool bloqueado){
+/*
+    Atualiza um único lugar, por exemplo quando um monstro é morto.
+*/
+    F->bloqueado[(size_t)i*F->w+j] = bloqueado;
+    //Um lugar só muda os saltos da sua coluna e das vizinhas
+    if (F->saltosProntos)
+        for (int c=j-1; c<=j+1; c++)
+            if (c>=0 && c<F->w)
+                updateJumpColumn(F,c);
+}
+
+/*------------------------------------------------------------------------------
+    Heap binária (com entradas repetidas: as obsoletas são descartadas ao sair)
+------------------------------------------------------------------------------*/
+
+static bool heapPush(pathFinder* F, int64_t chave, int lugar){
+    if (F->heapLen==F->heapCap){
+        heapItem* novo = realloc(F->heap,2*(size_t)F->heapCap*sizeof(heapItem));
+        if (novo==NULL)
+            return false;
+        F->heap = novo;
+        F->heapCap *= 2;
+    }
+    int k = F->heapLen++;
+    while (k>0){
+        int p = (k-1)/2;
+        if (F->heap[p].chave<=chave) break;
+        F->heap[k] = F->heap[p];
+        k = p;
+    }
+    F->heap[k].chave = chave;
+    F->heap[k].lugar = lugar;
+    return true;
+}
+
+static heapItem heapPop(pathFinder* F){
+    heapItem topo = F->heap[0];
+    heapItem ultimo = F->heap[--F->heapLen];
+    int k = 0, n = F->heapLen;
+    while (2*k+1<n){
+        int c = 2*k+1;
+        if (c+1<n && F->heap[c+1].chave<F->heap[c].chave) c++;
+        if (F->heap[c].chave>=ultimo.chave) break;
+        F->heap[k] = F->heap[c];
+        k = c;
+    }
+    if (n>0) F->heap[k] = ultimo;
+    return topo;
+}
+
+//Com f igual, sai primeiro quem tem g maior (mais perto do destino)
+static int64_t key(int f, int g){
+    return ((int64_t)f<<32) | (uint32_t)(0x7fffffff-g);
+}
+
+/*------------------------------------------------------------------------------
+    Estado da busca
+------------------------------------------------------------------------------*/
+
+static void beginSearch(pathFinder* F){
+    F->base += 2;
+    if (F->base==0 || F->base==1){
+        memset(F->marca,0,(size_t)F->h*F->w*sizeof(unsigned int));
+        F->base = 2;
+    }
+    F->heapLen = 0;
+    F->expandidos = 0;
+}
+
+static bool isOpen(const pathFinder* F, int k){ return F->marca[k]==F->base; }
+static bool isClosed(const pathFinder* F, int k){ return F->marca[k]==F->base+1; }
+static bool seen(const pathFinder* F, int k){ return F->marca[k]>=F->base; }
+
+static bool freeCell(const pathFinder* F, int i, int j){
+    return i>=0 && i<F->h && j>=0 && j<F->w && !F->bloqueado[(size_t)i*F->w+j];
+}
+
+static int manhattan(int i, int j, int ti, int tj){
+    return abs(i-ti)+abs(j-tj);
+}
+
+static bool relax(pathFinder* F, int k, int pai, int g, int ti, int tj){
+/*
+    Abre k com custo g vindo de pai, se for melhor que o atual.
+*/
+    if (isClosed(F,k) || (seen(F,k) && F->g[k]<=g))
+        return true;
+    F->marca[k] = F->base;
+    F->g[k] = g;
+    F->pai[k] = pai;
+    int i = k/F->w, j = k%F->w;
+    return heapPush(F,key(g+manhattan(i,j,ti,tj),g),k);
+}
+
+static int buildPath(const pathFinder* F, int origem, int destino,
+    int* caminho, int max){
+/*
+    Reconstrói o caminho pelos pais. Pais da JPS podem estar a vários
+    lugares de distância, sempre em linha reta: os intermediários são
+    preenchidos.
+*/
+    int len = F->g[destino]+1;
+    if (caminho==NULL || len>max)
+        return len;
+    int pos = len-1;
+    int k = destino;
+    caminho[pos--] = k;
+    while (k!=origem){
+        int p = F->pai[k];
+        int i = k/F->w, j = k%F->w, pi = p/F->w, pj = p%F->w;
+        int di = (pi>i)-(pi<i), dj = (pj>j)-(pj<j);
+        while (i!=pi || j!=pj){
+            i += di; j += dj;
+            caminho[pos--] = i*F->w+j;
+        }
+        k = p;
+    }
+    return len;
+}
+
+/*------------------------------------------------------------------------------
+    A*
+------------------------------------------------------------------------------*/
+
+int findPathAStar(pathFinder* F, int si, int sj, int ti, int tj,
+    int* caminho, int max){
+/*
+    A* com heurística de Manhattan (admissível e consistente na
+    vizinhança-4 com custo 1).
+*/
+    if (!freeCell(F,si,sj) || !freeCell(F,ti,tj))
+        return -1;
+    beginSearch(F);
+    int origem = si*F->w+sj, destino = ti*F->w+tj;
+    relax(F,origem,origem,0,ti,tj);
+    while (F->heapLen>0){
+        heapItem it = heapPop(F);
+        int u = it.lugar;
+        if (!isOpen(F,u))
+            continue;
+        F->marca[u] = F->base+1;
+        F->expandidos++;
+        if (u==destino)
+            return buildPath(F,origem,destino,caminho,max);
+        int i = u/F->w, j = u%F->w;
+        static const int di[4] = {1,-1,0,0}, dj[4] = {0,0,1,-1};
+        for (int d=0; d<4; d++)
+            if (freeCell(F,i+di[d],j+dj[d]))
+                if (!relax(F,(i+di[d])*F->w+j+dj[d],u,F->g[u]+1,ti,tj))
+                    return -1;
+    }
+    return -1;
+}
+
+/*------------------------------------------------------------------------------
+    Jump Point Search (vizinhança-4)
+--------------------------------------------------------------------------------
+    Ordem canônica "horizontal primeiro": de um lugar alcançado andando na
+    horizontal, seguem a mesma direção e as duas verticais; de um lugar
+    alcançado na vertical, segue a mesma direção e só as horizontais
+    forçadas (lado livre com o lado de trás bloqueado). Os saltos param no
+    destino, em vizinhos forçados e, na vertical, na linha do destino.
+    Saltos horizontais param onde um salto vertical encontraria algo; os
+    saltos verticais vêm de uma tabela por coluna, então esse teste é O(1).
+------------------------------------------------------------------------------*/
+
+static bool forcedH(const pathFinder* F, int i, int j, int di, int dj){
+//Andando na vertical (di) e chegando em (i,j): o lado dj é forçado?
+    return freeCell(F,i,j+dj) && !freeCell(F,i-di,j+dj);
+}
+
+static int jumpValue(const pathFinder* F, int d, int i, int j){
+//Salto vertical de (i,j) na direção d, a partir do valor do vizinho
+    int di = d==0 ? 1 : -1;
+    int prox = i+di;
+    if (!freeCell(F,prox,j))
+        return 0;
+    if (forcedH(F,prox,j,di,1) || forcedH(F,prox,j,di,-1))
+        return 1;
+    int vp = F->salto[d][(size_t)prox*F->w+j];
+    return vp>0 ? vp+1 : vp-1;
+}
+
+static void updateJumpColumn(pathFinder* F, int j){
+/*
+    Recalcula os saltos verticais da coluna j de baixo para cima (d = 0) e
+    de cima para baixo (d = 1): o valor de um lugar sai do valor do
+    vizinho na direção do salto.
+*/
+    for (int i=F->h-1; i>=0; i--)
+        F->salto[0][(size_t)i*F->w+j] = jumpValue(F,0,i,j);
+    for (int i=0; i<F->h; i++)
+        F->salto[1][(size_t)i*F->w+j] = jumpValue(F,1,i,j);
+}
+
+static void updateJumpRow(pathFinder* F, int d, int i){
+/*
+    Mesmo cálculo de jumpValue para a linha i inteira, percorrendo a
+    memória em ordem e sem testes de borda no meio da linha.
+*/
+    int w = F->w, prox = i+(d==0 ? 1 : -1);
+    int* S = F->salto[d]+(size_t)i*w;
+    if (prox<0 || prox>=F->h || w<3){
+        for (int j=0; j<w; j++)
+            S[j] = jumpValue(F,d,i,j);
+        return;
+    }
+    const unsigned char* B = F->bloqueado+(size_t)prox*w;   //linha de chegada
+    const unsigned char* A = F->bloqueado+(size_t)i*w;      //linha de trás
+    const int* P = F->salto[d]+(size_t)prox*w;
+    S[0] = jumpValue(F,d,i,0);
+    for (int j=1; j<w-1; j++){
+        if (B[j])
+            S[j] = 0;
+        else if ((!B[j+1] && A[j+1]) || (!B[j-1] && A[j-1]))
+            S[j] = 1;
+        else
+            S[j] = P[j]>0 ? P[j]+1 : P[j]-1;
+    }
+    S[w-1] = jumpValue(F,d,i,w-1);
+}
+
+static bool prepareJumps(pathFinder* F){
+/*
+    Aloca e calcula os saltos verticais na primeira busca JPS (ou depois de
+    pathFinderSync): O(h*w) uma vez por mapa, em vez de varrer colunas
+    inteiras a cada passo dos saltos horizontais.
+*/
+    if (F->saltosProntos)
+        return true;
+    size_t n = (size_t)F->h*F->w;
+    for (int d=0; d<2; d++)
+        if (F->salto[d]==NULL && (F->salto[d] = malloc(n*sizeof(int)))==NULL)
+            return false;
+    for (int i=F->h-1; i>=0; i--)
+        updateJumpRow(F,0,i);
+    for (int i=0; i<F->h; i++)
+        updateJumpRow(F,1,i);
+    F->saltosProntos = true;
+    return true;
+}
+
+static int jumpV(const pathFinder* F, int i, int j, int di, int ti){
+/*
+    O(1) pela tabela: para na linha do destino se ela estiver antes da
+    próxima parede e do próximo ponto de salto.
+*/
+    int v = F->salto[di>0 ? 0 : 1][(size_t)i*F->w+j];
+    int alcance = v>0 ? v : -v;
+    int ate = (ti-i)*di;
+    if (ate>=1 && ate<=alcance) //inclui o próprio destino
+        return ti*F->w+j;
+    return v>0 ? (i+di*v)*F->w+j : -1;
+}
+
+static int jumpH(const pathFinder* F, int i, int j, int dj, int ti, int tj){
+    for (;;){
+        j += dj;
+        if (!freeCell(F,i,j))
+            return -1;
+        if (i==ti && j==tj)
+            return i*F->w+j;
+        if (jumpV(F,i,j,1,ti)!=-1 || jumpV(F,i,j,-1,ti)!=-1)
+            return i*F->w+j;
+    }
+}
+
+int findPathJPS(pathFinder* F, int si, int sj, int ti, int tj,
+    int* caminho, int max){
+    if (!freeCell(F,si,sj) || !freeCell(F,ti,tj))
+        return -1;
+    if (!prepareJumps(F))
+        return -1;
+    beginSearch(F);
+    int origem = si*F->w+sj, destino = ti*F->w+tj;
+    relax(F,origem,origem,0,ti,tj);
+    while (F->heapLen>0){
+        heapItem it = heapPop(F);
+        int u = it.lugar;
+        if (!isOpen(F,u))
+            continue;
+        F->marca[u] = F->base+1;
+        F->expandidos++;
+        if (u==destino)
+            return buildPath(F,origem,destino,caminho,max);
+
+        int i = u/F->w, j = u%F->w;
+        int p = F->pai[u], pi = p/F->w, pj = p%F->w;
+        int vi = (i>pi)-(i<pi), vj = (j>pj)-(j<pj); //direção de chegada
+
+        //Direções a expandir: (di, dj)
+        int dirs[4][2], n = 0;
+        if (u==origem){
+            dirs[n][0]=1;  dirs[n++][1]=0;
+            dirs[n][0]=-1; dirs[n++][1]=0;
+            dirs[n][0]=0;  dirs[n++][1]=1;
+            dirs[n][0]=0;  dirs[n++][1]=-1;
+        } else if (vj!=0){
+            dirs[n][0]=0;  dirs[n++][1]=vj;
+            dirs[n][0]=1;  dirs[n++][1]=0;
+            dirs[n][0]=-1; dirs[n++][1]=0;
+        } else {
+            dirs[n][0]=vi; dirs[n++][1]=0;
+            for (int s=-1; s<=1; s+=2)
+                if (i==ti || forcedH(F,i,j,vi,s)){
+                    dirs[n][0]=0; dirs[n++][1]=s;
+                }
+        }
+
+        for (int d=0; d<n; d++){
+            int jp = dirs[d][0]!=0 ? jumpV(F,i,j,dirs[d][0],ti)
+                                   : jumpH(F,i,j,dirs[d][1],ti,tj);
+            if (jp==-1)
+                continue;
+            int ji = jp/F->w, jj = jp%F->w;
+            if (!relax(F,jp,u,F->g[u]+abs(ji-i)+abs(jj-j),ti,tj))
+                return -1;
+        }
+    }
+    return -1;
+}
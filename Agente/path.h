@@ -0,0 +1,51 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "env.h"
+
+#ifndef PATH_H
+#define PATH_H
+
+/*
+    Busca de caminhos no grid com vizinhança-4. Buracos e monstros vivos são
+    obstáculos. Toda a memória da busca (custos, pais, marcas e heap) fica no
+    pathFinder e é reutilizada entre chamadas; marcas por geração evitam
+    limpar os vetores a cada busca.
+*/
+
+typedef struct{
+    int64_t chave;      //f em cima, desempate por g maior embaixo
+    int lugar;
+} heapItem;
+
+typedef struct{
+    int h, w;
+    unsigned char* bloqueado;   //h*w: 1 se obstáculo
+    unsigned int* marca;        //base: aberto, base+1: fechado
+    unsigned int base;
+    int* g;
+    int* pai;
+    heapItem* heap;
+    int heapLen, heapCap;
+    long long expandidos;       //nós expandidos na última busca
+    //Saltos verticais da JPS, calculados na primeira busca e mantidos em
+    //dia pelas alterações de obstáculos: salto[d][k] > 0 é a distância até
+    //o próximo ponto de salto na direção d (0: baixo, 1: cima); <= 0 é
+    //menos o número de lugares livres antes de uma parede
+    int* salto[2];
+    bool saltosProntos;
+} pathFinder;
+
+pathFinder* newPathFinder(int h, int w);
+void delPathFinder(pathFinder* F);
+void pathFinderSync(pathFinder* F, enviroment E);
+void pathFinderSetBlocked(pathFinder* F, int i, int j, bool bloqueado);
+
+//Retornam o número de lugares do caminho (incluindo origem e destino) ou -1
+//se não houver caminho. O caminho (índices i*w+j) só é escrito em
+//'caminho' se couber em 'max' posições.
+int findPathAStar(pathFinder* F, int si, int sj, int ti, int tj,
+    int* caminho, int max);
+int findPathJPS(pathFinder* F, int si, int sj, int ti, int tj,
+    int* caminho, int max);
+
+#endif
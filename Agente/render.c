@@ -0,0 +1,173 @@
+#include "render.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static int digits(int x){
+    int n = 1;
+    while (x>=10){ x /= 10; n++; }
+    return n;
+}
+
+renderer* newRenderer(int h, int w, double fps, FILE* saida){
+/*
+    O buffer comporta o pior caso de uma linha (todos os lugares mudando,
+    cada um com sua sequência de cursor), com folga para várias linhas em
+    grids pequenos; o quadro é emitido em pedaços sempre que a próxima
+    linha pode não caber.
+*/
+    renderer* R = malloc(sizeof(renderer));
+    if (R==NULL)
+        return NULL;
+    R->h = h; R->w = w;
+    size_t cursor = 4 + digits(h+1) + digits(2*w+1);
+    R->porLinha = (size_t)w*(2+cursor) + 1 + cursor;
+    R->cap = R->porLinha + 16;
+    if (R->cap<(1<<16))
+        R->cap = 1<<16;
+    R->anterior = malloc((size_t)h*w);
+    R->buf = malloc(R->cap);
+    R->len = 0;
+    R->intervalo = fps>0 ? 1.0/fps : 0.0;
+    R->ultimo = 0.0;
+    R->completo = true;
+    R->revelar = false;
+    R->saida = saida;
+    R->gravacao = NULL;
+    if (R->anterior==NULL || R->buf==NULL){
+        delRenderer(R);
+        return NULL;
+    }
+    return R;
+}
+
+void delRenderer(renderer* R){
+    if (R!=NULL){
+        if (R->gravacao!=NULL)
+            fclose(R->gravacao);
+        free(R->anterior);
+        free(R->buf);
+        free(R);
+    }
+}
+
+bool rendererRecord(renderer* R, const char* arquivo){
+/*
+    Passa a gravar tudo o que é emitido em arquivo (reproduzível com cat).
+    O próximo quadro é completo, para a gravação começar num estado válido.
+*/
+    if (R->gravacao!=NULL)
+        fclose(R->gravacao);
+    R->gravacao = fopen(arquivo,"wb");
+    R->completo = true;
+    return R->gravacao!=NULL;
+}
+
+void rendererInvalidate(renderer* R){
+    R->completo = true;
+}
+
+/*------------------------------------------------------------------------------
+    Montagem do quadro
+------------------------------------------------------------------------------*/
+
+static void emit(renderer* R){
+    fwrite(R->buf,1,R->len,R->saida);
+    if (R->gravacao!=NULL)
+        fwrite(R->buf,1,R->len,R->gravacao);
+    R->len = 0;
+}
+
+static void reserveRow(renderer* R){
+//Esvazia o buffer se a próxima linha (no pior caso) pode não caber
+    if (R->cap-R->len<R->porLinha)
+        emit(R);
+}
+
+static void put(renderer* R, const char* s, size_t n){
+    memcpy(R->buf+R->len,s,n);
+    R->len += n;
+}
+
+static void putInt(renderer* R, int x){
+    char tmp[12];
+    int n = 0;
+    do{ tmp[n++] = '0'+x%10; x /= 10; } while (x>0);
+    while (n>0) R->buf[R->len++] = tmp[--n];
+}
+
+static void putCursor(renderer* R, int linha, int coluna){
+    put(R,"\x1b[",2);
+    putInt(R,linha);
+    R->buf[R->len++] = ';';
+    putInt(R,coluna);
+    R->buf[R->len++] = 'H';
+}
+
+static char cellChar(const renderer* R, agent A, const place* p){
+    if (p->row==A.row && p->col==A.col)
+        return 'O';
+    if (R->revelar){
+        if (p->buraco)  return 'B';
+        if (p->monstro) return 'M';
+        if (p->ouro)    return '$';
+    }
+    return '_';
+}
+
+bool renderFrame(renderer* R, agent A, enviroment E, bool forcar){
+/*
+    Emite um quadro, a menos que o limite de quadros por segundo não permita
+    (e forcar seja falso). Quadros pulados não se perdem: o próximo quadro
+    emitido é comparado com o último que saiu de fato.
+*/
+    double t = now();
+    if (!forcar && !R->completo && t-R->ultimo<R->intervalo)
+        return false;
+    R->len = 0;
+
+    if (R->completo){
+        put(R,"\x1b[H\x1b[2J",7);
+        for (int i=0; i<R->h; i++){
+            reserveRow(R);
+            for (int j=0; j<R->w; j++){
+                char c = cellChar(R,A,getPlace(E,i,j));
+                R->anterior[(size_t)i*R->w+j] = c;
+                R->buf[R->len++] = c;
+                R->buf[R->len++] = ' ';
+            }
+            R->buf[R->len++] = '\n';
+        }
+        R->completo = false;
+    } else {
+        for (int i=0; i<R->h; i++){
+            reserveRow(R);
+            int cursor = -1; //coluna do grid onde o cursor está, nesta linha
+            for (int j=0; j<R->w; j++){
+                size_t k = (size_t)i*R->w+j;
+                char c = cellChar(R,A,&E.grid[k]);
+                if (c==R->anterior[k])
+                    continue;
+                R->anterior[k] = c;
+                if (cursor!=j)
+                    putCursor(R,i+1,2*j+1);
+                R->buf[R->len++] = c;
+                R->buf[R->len++] = ' ';
+                cursor = j+1;
+            }
+        }
+        reserveRow(R);
+        putCursor(R,R->h+1,1);
+    }
+
+    emit(R);
+    fflush(R->saida);
+    R->ultimo = t;
+    return true;
+}
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include "agent.h"
+
+#ifndef RENDER_H
+#define RENDER_H
+
+/*
+    Renderizador incremental para terminais ANSI. Cada quadro é montado num
+    buffer pré-alocado do tamanho de uma linha no pior caso (esvaziado
+    entre linhas quando enche) e só os lugares que mudaram desde o último
+    quadro emitido são reescritos, com posicionamento de cursor. O desenho
+    segue printSimulation ("O " para o agente, "_ " para os demais lugares).
+*/
+
+typedef struct{
+    int h, w;
+    char* anterior;     //h*w: caractere de cada lugar no último quadro
+    char* buf;
+    size_t cap, len;
+    size_t porLinha;    //bytes de uma linha no pior caso
+    double intervalo;   //segundos mínimos entre quadros (0: sem limite)
+    double ultimo;      //instante do último quadro emitido
+    bool completo;      //o próximo quadro redesenha tudo
+    bool revelar;       //mostra buracos (B), monstros (M) e ouro ($)
+    FILE* saida;
+    FILE* gravacao;     //opcional: cópia dos bytes emitidos
+} renderer;
+
+renderer* newRenderer(int h, int w, double fps, FILE* saida);
+void delRenderer(renderer* R);
+bool rendererRecord(renderer* R, const char* arquivo);
+void rendererInvalidate(renderer* R);
+bool renderFrame(renderer* R, agent A, enviroment E, bool forcar);
+
+#endif
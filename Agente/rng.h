@@ -0,0 +1,33 @@
+#include <stdint.h>
+
+#ifndef RNG_H
+#define RNG_H
+
+/*
+    Gerador pseudoaleatório pequeno e rápido (splitmix64). Cada ambiente,
+    episódio ou thread mantém seu próprio estado, então os sorteios são
+    reprodutíveis a partir da semente e independentes entre threads.
+*/
+typedef struct{
+    uint64_t s;
+} rngState;
+
+static inline rngState newRng(uint64_t seed){
+    rngState r;
+    r.s = seed;
+    return r;
+}
+
+static inline uint64_t rngNext(rngState* r){
+    uint64_t z = (r->s += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z>>27)) * 0x94d049bb133111ebull;
+    return z ^ (z>>31);
+}
+
+//Inteiro em [0, n), por multiplicação (Lemire), sem divisão
+static inline uint64_t rngBounded(rngState* r, uint64_t n){
+    return (uint64_t)(((unsigned __int128)rngNext(r) * n) >> 64);
+}
+
+#endif
@@ -0,0 +1,258 @@
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+/*------------------------------------------------------------------------------
+    Episódio
+------------------------------------------------------------------------------*/
+
+static fimEpisodio episode(enviroment E, const bitEnviroment* B,
+    const policy* P, void* state, int maxPassos, unsigned int* rng,
+    int* score, int* passos){
+/*
+    Roda um episódio sem nenhuma saída, lendo e alterando os planos de bits
+    B quando dados e o grid de E caso contrário. O episódio termina quando o
+    agente escapa com o ouro, morre ou atinge maxPassos. Ações que sairiam
+    do grid contam como passo mas não mudam o score.
+*/
+    agent A = newAgent(E);
+    observation obs;
+    obs.h = E.h; obs.w = E.w;
+    fimEpisodio fim = FIM_LIMITE;
+    int n;
+    for (n=0; n<maxPassos; n++){
+        obs.row = A.row; obs.col = A.col;
+        obs.S = B ? bitSensation(*B,A.row,A.col) : getPlace(E,A.row,A.col)->S;
+        obs.comOuro = A.comOuro;
+        obs.temFlecha = A.temFlecha;
+        obs.score = A.score;
+        obs.passos = n;
+
+        int i = A.row, j = A.col;
+        switch (P->decide(state,&obs,rng)){
+            case ACAO_BAIXO:    i++; break;
+            case ACAO_CIMA:     i--; break;
+            case ACAO_DIREITA:  j++; break;
+            case ACAO_ESQUERDA: j--; break;
+        }
+        if (i<0 || i>=E.h || j<0 || j>=E.w)
+            continue;
+        int ev = B ? bitStep(&A,*B,i,j) : step(&A,E,getPlace(E,i,j));
+        if (ev & EV_BURACO){ fim = FIM_BURACO; n++; break; }
+        if (ev & EV_PEGO){ fim = FIM_MONSTRO; n++; break; }
+        if (ev & EV_ESCAPOU){ fim = FIM_ESCAPOU; n++; break; }
+    }
+    *score = A.score;
+    *passos = n;
+    return fim;
+}
+
+fimEpisodio runEpisode(enviroment E, const policy* P, void* state,
+    int maxPassos, unsigned int* rng, int* score, int* passos){
+/*
+    Episódio em E (já inicializado).
+*/
+    return episode(E,NULL,P,state,maxPassos,rng,score,passos);
+}
+
+fimEpisodio runEpisodeBit(bitEnviroment B, const policy* P, void* state,
+    int maxPassos, unsigned int* rng, int* score, int* passos){
+/*
+    Episódio em B (já inicializado, ver bitLoadEnviroment).
+*/
+    enviroment dims;
+    dims.h = B.h; dims.w = B.w; dims.grid = NULL;
+    return episode(dims,&B,P,state,maxPassos,rng,score,passos);
+}
+
+/*------------------------------------------------------------------------------
+    Execução em lote
+------------------------------------------------------------------------------*/
+
+#define SIM_LOTE 64 //episódios reservados por vez por cada thread
+
+typedef struct{
+    const simConfig* C;
+    const policy* P;
+    atomic_llong* proximo;
+    simStats S;
+} simWorker;
+
+static void emptyStats(simStats* S){
+    S->episodios = S->vitorias = S->mortesBuraco = S->mortesMonstro = 0;
+    S->limitePassos = S->somaPassos = 0;
+    S->somaScore = S->somaScore2 = 0.0;
+    S->scoreMin = 0; S->scoreMax = 0;
+    S->segundos = 0.0;
+}
+
+static void addEpisode(simStats* S, fimEpisodio fim, int score, int passos){
+    if (S->episodios==0 || score<S->scoreMin) S->scoreMin = score;
+    if (S->episodios==0 || score>S->scoreMax) S->scoreMax = score;
+    S->episodios++;
+    S->somaPassos += passos;
+    S->somaScore += score;
+    S->somaScore2 += (double)score*score;
+    switch (fim){
+        case FIM_ESCAPOU: S->vitorias++; break;
+        case FIM_BURACO:  S->mortesBuraco++; break;
+        case FIM_MONSTRO: S->mortesMonstro++; break;
+        case FIM_LIMITE:  S->limitePassos++; break;
+    }
+}
+
+static void mergeStats(simStats* S, const simStats* T){
+    if (T->episodios==0) return;
+    if (S->episodios==0 || T->scoreMin<S->scoreMin) S->scoreMin = T->scoreMin;
+    if (S->episodios==0 || T->scoreMax>S->scoreMax) S->scoreMax = T->scoreMax;
+    S->episodios += T->episodios;
+    S->vitorias += T->vitorias;
+    S->mortesBuraco += T->mortesBuraco;
+    S->mortesMonstro += T->mortesMonstro;
+    S->limitePassos += T->limitePassos;
+    S->somaPassos += T->somaPassos;
+    S->somaScore += T->somaScore;
+    S->somaScore2 += T->somaScore2;
+}
+
+static void* simThread(void* arg){
+/*
+    Cada thread reutiliza um único grid e um único estado de política,
+    reservando lotes de episódios de um contador compartilhado.
+*/
+    simWorker* W = arg;
+    const simConfig* C = W->C;
+    const policy* P = W->P;
+    enviroment E = newEnviroment(C->h,C->w);
+    if (E.grid==NULL)
+        return NULL;
+    //Com bitPlanes o grid só gera o episódio; as regras rodam nos planos
+    bitEnviroment B;
+    B.buraco = B.monstro = B.ouro = B.vento = B.cheiro = NULL;
+    if (C->bitPlanes){
+        B = newBitEnviroment(C->h,C->w);
+        if (B.buraco==NULL || B.monstro==NULL || B.ouro==NULL
+            || B.vento==NULL || B.cheiro==NULL){
+            delBitEnviroment(&B);
+            delEnviroment(&E);
+            return NULL;
+        }
+    }
+    void* state = P->create ? P->create(C->h,C->w,P->arg) : P->arg;
+    if (P->create && state==NULL){
+        //Sem estado não há episódio; as outras threads ficam com o lote
+        delBitEnviroment(&B);
+        delEnviroment(&E);
+        return NULL;
+    }
+    emptyStats(&W->S);
+
+    long long k;
+    while ((k = atomic_fetch_add(W->proximo,SIM_LOTE)) < C->episodios){
+        long long fimLote = k+SIM_LOTE < C->episodios ? k+SIM_LOTE : C->episodios;
+        for (; k<fimLote; k++){
+            uint64_t seed = C->seed + (uint64_t)k;
+            unsigned int rng = (unsigned int)(seed ^ (seed>>32)) ^ 0x9e3779b9u;
+            clearEnviroment(E);
+            initEnviromentSeed(E,C->numBuraco,C->numMonstro,seed);
+            if (P->reset) P->reset(state);
+            int score, passos;
+            fimEpisodio fim;
+            if (C->bitPlanes){
+                bitLoadEnviroment(B,E);
+                fim = runEpisodeBit(B,P,state,C->maxPassos,&rng,&score,&passos);
+            }
+            else
+                fim = runEpisode(E,P,state,C->maxPassos,&rng,&score,&passos);
+            addEpisode(&W->S,fim,score,passos);
+        }
+    }
+
+    if (P->create && P->destroy) P->destroy(state);
+    delBitEnviroment(&B);
+    delEnviroment(&E);
+    return NULL;
+}
+
+simStats simulate(simConfig C, const policy* P){
+/*
+    Roda C.episodios episódios em C.threads threads e agrega as estatísticas.
+    O resultado não depende do número de threads: o episódio k sempre usa a
+    semente C.seed+k.
+*/
+    int T = C.threads;
+    if (T<=0){
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        T = n>0 ? (int)n : 1;
+    }
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+
+    atomic_llong proximo;
+    atomic_init(&proximo,0);
+    simWorker* W = malloc(T*sizeof(simWorker));
+    pthread_t* th = malloc(T*sizeof(pthread_t));
+    simStats S;
+    emptyStats(&S);
+    if (W==NULL || th==NULL){
+        free(W); free(th);
+        return S;
+    }
+    for (int t=0; t<T; t++){
+        W[t].C = &C; W[t].P = P; W[t].proximo = &proximo;
+        emptyStats(&W[t].S);
+    }
+    //Se uma thread não puder ser criada, as que já existem e a thread
+    //atual dão conta de todos os episódios pelo contador compartilhado
+    int criadas = 1;
+    while (criadas<T && pthread_create(&th[criadas],NULL,simThread,&W[criadas])==0)
+        criadas++;
+    simThread(&W[0]);
+    for (int t=1; t<criadas; t++)
+        pthread_join(th[t],NULL);
+    for (int t=0; t<T; t++)
+        mergeStats(&S,&W[t].S);
+    free(W); free(th);
+
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    S.segundos = (t1.tv_sec-t0.tv_sec) + (t1.tv_nsec-t0.tv_nsec)*1e-9;
+    return S;
+}
+
+void printStats(simStats S){
+    if (S.episodios==0){
+        printf("Nenhum episódio executado. \n");
+        return;
+    }
+    double n = (double)S.episodios;
+    double media = S.somaScore/n;
+    double var = S.episodios>1 ? (S.somaScore2 - n*media*media)/(n-1) : 0.0;
+    printf("Episódios: %lld (%.0f episódios/s) \n", S.episodios,
+        S.segundos>0 ? n/S.segundos : 0.0);
+    printf("Vitórias: %lld (%.2f%%) \n", S.vitorias, 100.0*S.vitorias/n);
+    printf("Mortes por buraco: %lld, por monstro: %lld, limite de passos: %lld \n",
+        S.mortesBuraco, S.mortesMonstro, S.limitePassos);
+    printf("Score médio: %.2f (desvio padrão %.2f, min %d, max %d) \n",
+        media, var>0 ? sqrt(var) : 0.0, S.scoreMin, S.scoreMax);
+    printf("Passos médios: %.2f \n", S.somaPassos/n);
+}
+
+/*------------------------------------------------------------------------------
+    Políticas de exemplo
+------------------------------------------------------------------------------*/
+
+acao randomPolicy(void* state, const observation* obs, unsigned int* rng){
+/*
+    Anda ao acaso (xorshift sobre o estado do episódio).
+*/
+    (void)state; (void)obs;
+    unsigned int x = *rng;
+    x ^= x<<13; x ^= x>>17; x ^= x<<5;
+    *rng = x;
+    return (acao)(x>>30);
+}
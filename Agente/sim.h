@@ -0,0 +1,83 @@
+#include <stdbool.h>
+#include "agent.h"
+#include "bitenv.h"
+
+#ifndef SIM_H
+#define SIM_H
+
+/*
+    Simulação sem interface: uma política escolhe as ações do agente a partir
+    apenas do que ele percebe, e muitos episódios rodam em paralelo, cada um
+    com seu próprio ambiente gerado a partir de uma semente.
+*/
+
+//Ações, com as mesmas letras do jogo interativo
+typedef enum{
+    ACAO_BAIXO,     //'b'
+    ACAO_CIMA,      //'c'
+    ACAO_DIREITA,   //'d'
+    ACAO_ESQUERDA   //'e'
+} acao;
+
+//O que o agente percebe a cada passo
+typedef struct{
+    int h, w;
+    int row, col;
+    sensation S;
+    bool comOuro;
+    bool temFlecha;
+    int score;
+    int passos;
+} observation;
+
+//Política do agente. Apenas decide é obrigatória: create/reset/destroy
+//permitem manter estado por thread, reutilizado entre episódios.
+typedef struct{
+    void* (*create)(int h, int w, void* arg);
+    void (*reset)(void* state);
+    acao (*decide)(void* state, const observation* obs, unsigned int* rng);
+    void (*destroy)(void* state);
+    void* arg;
+} policy;
+
+//Como terminou um episódio
+typedef enum{
+    FIM_ESCAPOU,
+    FIM_BURACO,
+    FIM_MONSTRO,
+    FIM_LIMITE
+} fimEpisodio;
+
+typedef struct{
+    int h, w;
+    int numBuraco, numMonstro;
+    int maxPassos;              //limite de passos por episódio
+    long long episodios;
+    int threads;                //<= 0: número de núcleos
+    uint64_t seed;              //episódio k usa a semente seed+k
+    bool bitPlanes;             //regras e sensações sobre os planos de bits
+} simConfig;
+
+typedef struct{
+    long long episodios;
+    long long vitorias;
+    long long mortesBuraco;
+    long long mortesMonstro;
+    long long limitePassos;
+    long long somaPassos;
+    double somaScore;
+    double somaScore2;
+    int scoreMin, scoreMax;
+    double segundos;
+} simStats;
+
+fimEpisodio runEpisode(enviroment E, const policy* P, void* state,
+    int maxPassos, unsigned int* rng, int* score, int* passos);
+fimEpisodio runEpisodeBit(bitEnviroment B, const policy* P, void* state,
+    int maxPassos, unsigned int* rng, int* score, int* passos);
+simStats simulate(simConfig C, const policy* P);
+void printStats(simStats S);
+
+acao randomPolicy(void* state, const observation* obs, unsigned int* rng);
+
+#endif
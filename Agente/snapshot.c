@@ -0,0 +1,166 @@
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+    Contagem de referências
+------------------------------------------------------------------------------*/
+
+static void releaseBloco(bloco* b){
+    if (b!=NULL && atomic_fetch_sub(&b->refs,1)==1)
+        free(b);
+}
+
+static void releasePagina(pagina* p){
+    if (p!=NULL && atomic_fetch_sub(&p->refs,1)==1){
+        for (int k=0; k<PAGINA_BLOCOS; k++)
+            releaseBloco(p->blocos[k]);
+        free(p);
+    }
+}
+
+/*------------------------------------------------------------------------------
+    Criação, clonagem e liberação
+------------------------------------------------------------------------------*/
+
+static world* allocWorld(int h, int w){
+    world* W = malloc(sizeof(world));
+    if (W==NULL)
+        return NULL;
+    W->h = h; W->w = w;
+    W->bh = (h+BLOCO_LADO-1)/BLOCO_LADO;
+    W->bw = (w+BLOCO_LADO-1)/BLOCO_LADO;
+    W->numPaginas = (W->bh*W->bw+PAGINA_BLOCOS-1)/PAGINA_BLOCOS;
+    W->paginas = calloc(W->numPaginas,sizeof(pagina*));
+    if (W->paginas==NULL){
+        free(W);
+        return NULL;
+    }
+    return W;
+}
+
+world* newWorld(enviroment E, agent A){
+/*
+    Tira um instantâneo de E e A. Os lugares fora do grid no último bloco de
+    cada linha/coluna ficam zerados e nunca são acessados.
+*/
+    world* W = allocWorld(E.h,E.w);
+    if (W==NULL)
+        return NULL;
+    W->A = A;
+    int numBlocos = W->bh*W->bw;
+    for (int p=0; p<W->numPaginas; p++){
+        pagina* pg = calloc(1,sizeof(pagina));
+        if (pg==NULL){
+            delWorld(W);
+            return NULL;
+        }
+        atomic_init(&pg->refs,1);
+        W->paginas[p] = pg;
+        for (int k=0; k<PAGINA_BLOCOS && p*PAGINA_BLOCOS+k<numBlocos; k++){
+            bloco* b = calloc(1,sizeof(bloco));
+            if (b==NULL){
+                delWorld(W);
+                return NULL;
+            }
+            atomic_init(&b->refs,1);
+            pg->blocos[k] = b;
+            int t = p*PAGINA_BLOCOS+k;
+            int i0 = (t/W->bw)*BLOCO_LADO, j0 = (t%W->bw)*BLOCO_LADO;
+            for (int di=0; di<BLOCO_LADO && i0+di<E.h; di++)
+                for (int dj=0; dj<BLOCO_LADO && j0+dj<E.w; dj++)
+                    b->lugares[di*BLOCO_LADO+dj] = *getPlace(E,i0+di,j0+dj);
+        }
+    }
+    return W;
+}
+
+world* cloneWorld(const world* W){
+/*
+    Compartilha todas as páginas: custo proporcional ao número de páginas,
+    não ao tamanho do grid.
+*/
+    world* C = allocWorld(W->h,W->w);
+    if (C==NULL)
+        return NULL;
+    C->A = W->A;
+    for (int p=0; p<W->numPaginas; p++){
+        atomic_fetch_add(&W->paginas[p]->refs,1);
+        C->paginas[p] = W->paginas[p];
+    }
+    return C;
+}
+
+void delWorld(world* W){
+    if (W!=NULL){
+        for (int p=0; p<W->numPaginas; p++)
+            releasePagina(W->paginas[p]);
+        free(W->paginas);
+        free(W);
+    }
+}
+
+/*------------------------------------------------------------------------------
+    Acesso
+------------------------------------------------------------------------------*/
+
+const place* worldGet(const world* W, int i, int j){
+    int t = (i/BLOCO_LADO)*W->bw + j/BLOCO_LADO;
+    const bloco* b = W->paginas[t/PAGINA_BLOCOS]->blocos[t%PAGINA_BLOCOS];
+    return &b->lugares[(i%BLOCO_LADO)*BLOCO_LADO + j%BLOCO_LADO];
+}
+
+place* worldGetMut(world* W, int i, int j){
+/*
+    Retorna o lugar (i,j) para escrita, copiando antes a página e o bloco se
+    algum outro clone ainda os referencia. Retorna NULL se faltar memória.
+*/
+    int t = (i/BLOCO_LADO)*W->bw + j/BLOCO_LADO;
+    int p = t/PAGINA_BLOCOS, k = t%PAGINA_BLOCOS;
+
+    pagina* pg = W->paginas[p];
+    if (atomic_load(&pg->refs)>1){
+        pagina* novo = malloc(sizeof(pagina));
+        if (novo==NULL)
+            return NULL;
+        memcpy(novo->blocos,pg->blocos,sizeof(pg->blocos));
+        atomic_init(&novo->refs,1);
+        for (int q=0; q<PAGINA_BLOCOS; q++)
+            if (novo->blocos[q]!=NULL)
+                atomic_fetch_add(&novo->blocos[q]->refs,1);
+        releasePagina(pg);
+        W->paginas[p] = pg = novo;
+    }
+
+    bloco* b = pg->blocos[k];
+    if (atomic_load(&b->refs)>1){
+        bloco* novo = malloc(sizeof(bloco));
+        if (novo==NULL)
+            return NULL;
+        memcpy(novo->lugares,b->lugares,sizeof(b->lugares));
+        atomic_init(&novo->refs,1);
+        releaseBloco(b);
+        pg->blocos[k] = b = novo;
+    }
+    return &b->lugares[(i%BLOCO_LADO)*BLOCO_LADO + j%BLOCO_LADO];
+}
+
+int worldStep(world* W, int i, int j){
+/*
+    Move o agente do mundo para (i,j) com as mesmas regras de step().
+    O lugar só é copiado para escrita quando o monstro vai ser morto, única
+    regra que altera o grid.
+*/
+    if (i<0 || i>=W->h || j<0 || j>=W->w)
+        return 0;
+    const place* q = worldGet(W,i,j);
+    place copia = *q;
+    if (q->monstro && W->A.temFlecha){
+        place* p = worldGetMut(W,i,j);
+        if (p==NULL)
+            return 0;
+        return stepPlace(&W->A,W->h,W->w,p);
+    }
+    //Sem escrita: as regras rodam sobre uma cópia local do lugar
+    return stepPlace(&W->A,W->h,W->w,&copia);
+}
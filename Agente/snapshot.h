@@ -0,0 +1,46 @@
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "agent.h"
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*
+    Cópias baratas de (ambiente, agente) para planejadores com busca.
+
+    O grid é dividido em blocos de BLOCO_LADO x BLOCO_LADO lugares, e os
+    ponteiros para os blocos em páginas de PAGINA_BLOCOS blocos. Blocos e
+    páginas têm contagem de referências: clonar um mundo copia só o vetor
+    de páginas, e escrever num lugar copia apenas a página e o bloco
+    envolvidos, se estiverem compartilhados com outro clone (copy-on-write).
+*/
+
+#define BLOCO_LADO 16
+#define PAGINA_BLOCOS 256
+
+typedef struct{
+    atomic_int refs;
+    place lugares[BLOCO_LADO*BLOCO_LADO];
+} bloco;
+
+typedef struct{
+    atomic_int refs;
+    bloco* blocos[PAGINA_BLOCOS];
+} pagina;
+
+typedef struct{
+    int h, w;
+    int bh, bw;         //blocos por coluna e por linha
+    int numPaginas;
+    pagina** paginas;
+    agent A;
+} world;
+
+world* newWorld(enviroment E, agent A);
+world* cloneWorld(const world* W);
+void delWorld(world* W);
+const place* worldGet(const world* W, int i, int j);
+place* worldGetMut(world* W, int i, int j);
+int worldStep(world* W, int i, int j);
+
+#endif
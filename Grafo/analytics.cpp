@@ -0,0 +1,237 @@
+#include "analytics.h"
+#include "parallel.h"
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Fotografia CSR
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void graphAnalytics::build(const graph& G, int threads) {
+    /*
+        Copia a(u) e in(v) para vetores contíguos. Os deslocamentos são
+        somas de prefixo dos graus; o preenchimento de cada nó é
+        independente e roda em paralelo.
+    */
+    threads = defaultThreads(threads);
+    this->n = G.size();
+    const int n = this->n;
+    this->out_off.assign(n + 1, 0);
+    this->in_off.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        this->out_off[u + 1] = this->out_off[u] + G.a[u].size();
+        this->in_off[u + 1] = this->in_off[u] + G.in[u].size();
+    }
+    this->out_to.resize(this->out_off[n]);
+    this->in_from.resize(this->in_off[n]);
+    parallelFor(threads, n, [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) {
+            int k = this->out_off[u];
+            for (const arc& ed : G.a[u]) this->out_to[k++] = ed.to;
+            k = this->in_off[u];
+            for (const arcRef& r : G.in[u]) this->in_from[k++] = r.from;
+        }
+    }, 1024);
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Graus
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void graphAnalytics::degreeHistograms(vector<long long>& in_hist, vector<long long>& out_hist, int threads) const {
+    threads = defaultThreads(threads);
+    const int n = this->n;
+    int max_in = 0, max_out = 0;
+    for (int u = 0; u < n; ++u) {
+        max_in = max(max_in, this->inDegree(u));
+        max_out = max(max_out, this->outDegree(u));
+    }
+    // Histogramas locais por thread, somados no final
+    vector< vector<long long> > li(threads, vector<long long>(max_in + 1, 0));
+    vector< vector<long long> > lo(threads, vector<long long>(max_out + 1, 0));
+    parallelFor(threads, n, [&](int b, int e, int tid) {
+        for (int u = b; u < e; ++u) {
+            li[tid][this->inDegree(u)]++;
+            lo[tid][this->outDegree(u)]++;
+        }
+    });
+    in_hist.assign(max_in + 1, 0);
+    out_hist.assign(max_out + 1, 0);
+    for (int t = 0; t < threads; ++t) {
+        for (int d = 0; d <= max_in; ++d) in_hist[d] += li[t][d];
+        for (int d = 0; d <= max_out; ++d) out_hist[d] += lo[t][d];
+    }
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    PageRank
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+// Soma parcial de uma thread, em linha de cache própria
+struct alignas(64) partialSum {
+    double v;
+};
+
+int graphAnalytics::iterate(const vector<double>& teleport, vector<double>& rank, double damping,
+                            double tol, int max_iter, int threads) const {
+    /*
+        Cada iteração tem duas passadas paralelas sobre os nós:
+        1) contrib[u] = rank[u] / grau_saída(u) e a massa dos nós sem saída;
+        2) "pull": rank'[v] = (1 - d) t[v] + d (soma de contrib dos que
+           chegam em v + massa_sem_saída t[v]).
+        Cada v é escrito por uma thread só (sem atômicos), e o laço interno
+        é uma redução sobre um trecho contíguo de in_from.
+    */
+    const int n = this->n;
+    rank = teleport;
+    if (n == 0) return 0;
+    vector<double> contrib(n), next(n);
+    vector<partialSum> dangling(threads), diff(threads);
+    int it = 0;
+    while (it < max_iter) {
+        it++;
+        for (int t = 0; t < threads; ++t) { dangling[t].v = 0.0; diff[t].v = 0.0; }
+        parallelFor(threads, n, [&](int b, int e, int tid) {
+            double massa = 0.0;
+            for (int u = b; u < e; ++u) {
+                int g = this->outDegree(u);
+                if (g == 0) { massa += rank[u]; contrib[u] = 0.0; }
+                else contrib[u] = rank[u] / g;
+            }
+            dangling[tid].v = massa;
+        });
+        double massa = 0.0;
+        for (int t = 0; t < threads; ++t) massa += dangling[t].v;
+
+        const int* from = this->in_from.data();
+        const double* c = contrib.data();
+        parallelFor(threads, n, [&](int b, int e, int tid) {
+            double delta = 0.0;
+            for (int v = b; v < e; ++v) {
+                double soma = 0.0;
+                for (int k = this->in_off[v]; k < this->in_off[v + 1]; ++k)
+                    soma += c[from[k]];
+                double r = (1.0 - damping) * teleport[v] + damping * (soma + massa * teleport[v]);
+                delta += fabs(r - rank[v]);
+                next[v] = r;
+            }
+            diff[tid].v = delta;
+        });
+        rank.swap(next);
+        double total = 0.0;
+        for (int t = 0; t < threads; ++t) total += diff[t].v;
+        if (total < tol) break;
+    }
+    return it;
+}
+
+int graphAnalytics::pageRank(vector<double>& rank, double damping, double tol,
+                             int max_iter, int threads) const {
+    threads = defaultThreads(threads);
+    vector<double> teleport(this->n, this->n > 0 ? 1.0 / this->n : 0.0);
+    return this->iterate(teleport, rank, damping, tol, max_iter, threads);
+}
+
+int graphAnalytics::personalizedPageRank(const vector<int>& seeds, vector<double>& rank, double damping,
+                                         double tol, int max_iter, int threads) const {
+    threads = defaultThreads(threads);
+    vector<double> teleport(this->n, 0.0);
+    int validas = 0;
+    for (int s : seeds)
+        if (s >= 0 && s < this->n) validas++;
+    if (validas == 0) {
+        cerr << "Erro: Nenhuma semente valida no PageRank personalizado." << endl;
+        rank.assign(this->n, 0.0);
+        return 0;
+    }
+    for (int s : seeds)
+        if (s >= 0 && s < this->n) teleport[s] += 1.0 / validas;
+    return this->iterate(teleport, rank, damping, tol, max_iter, threads);
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Intermediação por BFS amostradas
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void graphAnalytics::betweenness(vector<double>& bc, int samples, unsigned long long seed,
+                                 int threads) const {
+    /*
+        Brandes sem pesos: para cada origem, uma BFS conta os caminhos
+        mínimos (sigma) e depois as dependências são acumuladas na ordem
+        inversa da BFS. As origens são divididas entre as threads, cada uma
+        com sua área de trabalho e seu vetor de acumulação, somados no fim.
+    */
+    threads = defaultThreads(threads);
+    const int n = this->n;
+    bc.assign(n, 0.0);
+    if (n == 0 || samples <= 0) return;
+
+    vector<int> fontes(n);
+    for (int u = 0; u < n; ++u) fontes[u] = u;
+    int k = min(samples, n);
+    mt19937_64 gen(seed);
+    for (int i = 0; i < k; ++i) {
+        uniform_int_distribution<int> d(i, n - 1);
+        swap(fontes[i], fontes[d(gen)]);
+    }
+    fontes.resize(k);
+
+    vector< vector<double> > local(threads);
+    parallelFor(threads, k, [&](int b, int e, int tid) {
+        vector<double>& acc = local[tid];
+        acc.assign(n, 0.0);
+        vector<int> dist(n, -1), ordem;
+        vector<double> sigma(n, 0.0), delta(n, 0.0);
+        ordem.reserve(n);
+        for (int i = b; i < e; ++i) {
+            int s = fontes[i];
+            ordem.clear();
+            dist[s] = 0;
+            sigma[s] = 1.0;
+            ordem.push_back(s);
+            for (size_t h = 0; h < ordem.size(); ++h) {
+                int u = ordem[h];
+                for (int a = this->out_off[u]; a < this->out_off[u + 1]; ++a) {
+                    int v = this->out_to[a];
+                    if (dist[v] < 0) {
+                        dist[v] = dist[u] + 1;
+                        ordem.push_back(v);
+                    }
+                    if (dist[v] == dist[u] + 1) sigma[v] += sigma[u];
+                }
+            }
+            for (size_t h = ordem.size(); h-- > 0; ) {
+                int w = ordem[h];
+                for (int a = this->out_off[w]; a < this->out_off[w + 1]; ++a) {
+                    int v = this->out_to[a];
+                    if (dist[v] == dist[w] + 1) delta[w] += sigma[w] / sigma[v] * (1.0 + delta[v]);
+                }
+                if (w != s) acc[w] += delta[w];
+            }
+            // Limpa só o que a BFS tocou
+            for (int w : ordem) { dist[w] = -1; sigma[w] = 0.0; delta[w] = 0.0; }
+        }
+    }, 1);
+
+    double escala = (double)n / k;
+    parallelFor(threads, n, [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) {
+            double soma = 0.0;
+            for (const vector<double>& acc : local)
+                if (!acc.empty()) soma += acc[u];
+            bc[u] = soma * escala;
+        }
+    });
+}
@@ -0,0 +1,47 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include "graph.h"
+#include <vector>
+
+using namespace std;
+
+// Fotografia somente leitura da adjacência em CSR (arcos de saída e de
+// entrada em vetores contíguos), sobre a qual rodam as análises em
+// paralelo. Arcos repetidos entre o mesmo par (verbos diferentes) contam
+// com multiplicidade.
+class graphAnalytics {
+public:
+    int n = 0;
+    vector<int> out_off, out_to;        // arcos de saída de u: out_to[out_off[u] .. out_off[u+1])
+    vector<int> in_off, in_from;        // arcos de entrada de v: in_from[in_off[v] .. in_off[v+1])
+
+    void build(const graph& G, int threads = 0);
+
+    int outDegree(int u) const { return this->out_off[u + 1] - this->out_off[u]; }
+    int inDegree(int v) const { return this->in_off[v + 1] - this->in_off[v]; }
+
+    // hist[d] = número de nós com grau d
+    void degreeHistograms(vector<long long>& in_hist, vector<long long>& out_hist, int threads = 0) const;
+
+    // PageRank por iterações "pull" até a soma das variações ficar abaixo
+    // de tol. Retorna o número de iterações. A massa dos nós sem saída é
+    // redistribuída como o salto aleatório.
+    int pageRank(vector<double>& rank, double damping = 0.85, double tol = 1e-9,
+                 int max_iter = 100, int threads = 0) const;
+    // Idem, com o salto aleatório só para os nós de seeds (PageRank personalizado)
+    int personalizedPageRank(const vector<int>& seeds, vector<double>& rank, double damping = 0.85,
+                             double tol = 1e-9, int max_iter = 100, int threads = 0) const;
+
+    // Centralidade de intermediação aproximada (Brandes a partir de
+    // 'samples' origens sorteadas, escalada por n / samples). Com
+    // samples >= n é exata.
+    void betweenness(vector<double>& bc, int samples, unsigned long long seed = 1,
+                     int threads = 0) const;
+
+private:
+    int iterate(const vector<double>& teleport, vector<double>& rank, double damping,
+                double tol, int max_iter, int threads) const;
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "baseline.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Arquivo de baseline
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+static string sanitize(const string& S) {
+    /*
+        Mantém a chave numa linha e sem TAB/'|' (separadores do arquivo).
+    */
+    string r;
+    bool espaco = false;
+    for (char c : S) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '|') {
+            espaco = !r.empty();
+            continue;
+        }
+        if (espaco) { r += '_'; espaco = false; }
+        r += c;
+    }
+    return r;
+}
+
+string baselineStore::key(const string& algoritmo, const string& gerador, int tamanho,
+                          const string& maquina) {
+    return sanitize(algoritmo) + "|" + sanitize(gerador) + "|" + to_string(tamanho) + "|" + sanitize(maquina);
+}
+
+bool baselineStore::load(const string& path) {
+    ifstream F(path);
+    if (!F.is_open()) return false;
+    string line;
+    while (getline(F, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t tab = line.find('\t');
+        if (tab == string::npos) {
+            cerr << "Erro: Linha invalida no arquivo de baseline " << path << "." << endl;
+            return false;
+        }
+        vector<double>& v = this->samples[line.substr(0, tab)];
+        v.clear();
+        stringstream ss(line.substr(tab + 1));
+        string campo;
+        while (getline(ss, campo, ','))
+            if (!campo.empty()) v.push_back(atof(campo.c_str()));
+    }
+    return true;
+}
+
+bool baselineStore::save(const string& path) const {
+    ofstream F(path);
+    if (!F.is_open()) return false;
+    F << "# algoritmo|gerador|tamanho|maquina<TAB>ns por consulta em cada processo (mediana das rodadas)\n";
+    F.precision(9);
+    for (const auto& kv : this->samples) {
+        F << kv.first << '\t';
+        for (size_t i = 0; i < kv.second.size(); ++i)
+            F << (i ? "," : "") << kv.second[i];
+        F << '\n';
+    }
+    return (bool)F;
+}
+
+string machineFingerprint() {
+    string cpu = "cpu_desconhecida";
+    ifstream F("/proc/cpuinfo");
+    string line;
+    while (getline(F, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t p = line.find(':');
+            if (p != string::npos) cpu = line.substr(p + 1);
+            break;
+        }
+    }
+    string compilador = "desconhecido";
+#if defined(__VERSION__)
+    compilador = __VERSION__;
+#endif
+    return sanitize(cpu) + "/" + to_string(thread::hardware_concurrency()) + "t/" + sanitize(compilador);
+}
+
+bool pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool runSelf(const vector<string>& args) {
+#if defined(__linux__)
+    vector<char*> argv;
+    string nome = "/proc/self/exe";
+    argv.push_back(&nome[0]);
+    vector<string> copia = args;
+    for (string& a : copia) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+    cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int nulo = open("/dev/null", O_WRONLY);
+        if (nulo >= 0) dup2(nulo, STDOUT_FILENO);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+    (void)args;
+    return false;
+#endif
+}
+
+string tempFile() {
+#if defined(__linux__)
+    char nome[] = "/tmp/grafo_baselineXXXXXX";
+    int fd = mkstemp(nome);
+    if (fd < 0) return "";
+    close(fd);
+    return nome;
+#else
+    return "";
+#endif
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Estatística
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+double median(vector<double> v) {
+    if (v.empty()) return 0.0;
+    size_t h = v.size() / 2;
+    nth_element(v.begin(), v.begin() + h, v.end());
+    double m = v[h];
+    if (v.size() % 2 == 0) m = (m + *max_element(v.begin(), v.begin() + h)) / 2.0;
+    return m;
+}
+
+double mannWhitneyGreater(const vector<double>& base, const vector<double>& novo) {
+    /*
+        U = número de pares (b, n) com n > b (empates valem meio). Sem
+        empates e com até 20 amostras de cada lado, a distribuição de U sob
+        a hipótese nula é contada exatamente: f[m][k][u] = número de
+        ordenações de m novos e k base com estatística u, usando que o
+        maior elemento é novo (soma k a U) ou base (não soma).
+    */
+    const size_t n1 = base.size(), n2 = novo.size();
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    vector< pair<double, int> > todos;
+    for (double x : base) todos.push_back(make_pair(x, 0));
+    for (double y : novo) todos.push_back(make_pair(y, 1));
+    sort(todos.begin(), todos.end());
+
+    // Postos médios e correção de empates
+    const size_t n = todos.size();
+    double soma_postos_novo = 0.0, empates = 0.0;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && todos[j].first == todos[i].first) j++;
+        double posto = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k)
+            if (todos[k].second == 1) soma_postos_novo += posto;
+        double t = j - i;
+        empates += t * t * t - t;
+        i = j;
+    }
+    double U = soma_postos_novo - n2 * (n2 + 1) / 2.0;
+
+    if (empates == 0.0 && n1 <= 20 && n2 <= 20) {
+        const size_t umax = n1 * n2;
+        // f[m][k] é a distribuição de U com m novos e k base
+        vector< vector< vector<double> > > f(n2 + 1, vector< vector<double> >(n1 + 1));
+        for (size_t m = 0; m <= n2; ++m)
+            for (size_t k = 0; k <= n1; ++k) {
+                vector<double>& d = f[m][k];
+                d.assign(m * k + 1, 0.0);
+                if (m == 0 || k == 0) { d[0] = 1.0; continue; }
+                const vector<double>& a = f[m - 1][k];     // maior é novo: +k
+                const vector<double>& b = f[m][k - 1];     // maior é base
+                for (size_t u = 0; u < a.size(); ++u) d[u + k] += a[u];
+                for (size_t u = 0; u < b.size(); ++u) d[u] += b[u];
+            }
+        const vector<double>& d = f[n2][n1];
+        double total = 0.0, cauda = 0.0;
+        size_t u_obs = (size_t)llround(U);
+        for (size_t u = 0; u <= umax; ++u) {
+            total += d[u];
+            if (u >= u_obs) cauda += d[u];
+        }
+        return cauda / total;
+    }
+
+    double media = n1 * n2 / 2.0;
+    double var = n1 * n2 / 12.0 * ((n + 1) - empates / (double)(n * (n - 1)));
+    if (var <= 0.0) return 1.0;
+    double z = (U - media - 0.5) / sqrt(var);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
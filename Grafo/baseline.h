@@ -0,0 +1,45 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+// Amostras de tempo guardadas entre execuções do benchmark, uma lista por
+// chave (algoritmo, gerador do grafo, tamanho, máquina). Arquivo texto:
+// uma linha "chave<TAB>v1,v2,..." por chave.
+class baselineStore {
+public:
+    map< string, vector<double> > samples;
+
+    static string key(const string& algoritmo, const string& gerador, int tamanho,
+                      const string& maquina);
+
+    bool load(const string& path);      // false se o arquivo não existe ou é inválido
+    bool save(const string& path) const;
+};
+
+// Identificação da máquina: modelo da CPU, número de threads e compilador
+string machineFingerprint();
+
+// Prende a thread atual a uma CPU (sched_setaffinity). false se falhar.
+bool pinToCpu(int cpu);
+
+// Executa o próprio binário (/proc/self/exe) com args, saída padrão
+// descartada, e espera terminar. false se não conseguir ou se o processo
+// não terminar com código 0.
+bool runSelf(const vector<string>& args);
+
+// Cria um arquivo temporário vazio e devolve o caminho ("" se falhar)
+string tempFile();
+
+// Teste de Mann-Whitney unilateral: p-valor da hipótese de que as amostras
+// de 'novo' tendem a ser maiores que as de 'base'. Exato para amostras
+// pequenas sem empates, aproximação normal com correção de empates no resto.
+double mannWhitneyGreater(const vector<double>& base, const vector<double>& novo);
+
+double median(vector<double> v);
+
+#endif
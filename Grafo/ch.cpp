@@ -0,0 +1,315 @@
+#include "ch.h"
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Pré-processamento
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+typedef pair<int, int> PairInt;
+static const int INF = numeric_limits<int>::max();
+
+namespace {
+
+// Grafo dinâmico usado durante a contração
+struct chBuilder {
+    vector< vector<chArc> > out, in;
+    vector<char> contracted;
+    vector<int> deleted_neighbors;
+
+    // Busca de testemunha (reutilizada)
+    vector<int> dist;
+    vector<unsigned int> mark;
+    unsigned int generation = 0;
+
+    void addArc(int u, int v, int peso, int meio) {
+        /*
+            Insere u->v ou melhora o arco existente (mantém só o menor peso).
+        */
+        for (chArc& e : out[u]) {
+            if (e.other == v) {
+                if (peso < e.peso) {
+                    e.peso = peso; e.meio = meio;
+                    for (chArc& f : in[v])
+                        if (f.other == u) { f.peso = peso; f.meio = meio; break; }
+                }
+                return;
+            }
+        }
+        out[u].push_back(chArc{v, peso, meio});
+        in[v].push_back(chArc{u, peso, meio});
+    }
+
+    int witness(int source, int skip, int limit, int max_settled) {
+        /*
+            Dijkstra a partir de source sem passar por skip, até a distância
+            limit ou max_settled nós assentados. Deixa as distâncias em dist
+            (válidas onde mark == generation).
+        */
+        if (++generation == 0) { fill(mark.begin(), mark.end(), 0); generation = 1; }
+        priority_queue<PairInt, vector<PairInt>, greater<PairInt>> pq;
+        dist[source] = 0; mark[source] = generation;
+        pq.push({0, source});
+        int settled = 0;
+        while (!pq.empty()) {
+            int d = pq.top().first, u = pq.top().second;
+            pq.pop();
+            if (d > dist[u]) continue;
+            if (d > limit || ++settled > max_settled) break;
+            for (const chArc& e : out[u]) {
+                int v = e.other;
+                if (v == skip || contracted[v]) continue;
+                int nd = d + e.peso;
+                if (mark[v] != generation || nd < dist[v]) {
+                    mark[v] = generation; dist[v] = nd;
+                    pq.push({nd, v});
+                }
+            }
+        }
+        return settled;
+    }
+
+    int contract(int v, int max_settled, bool simulate, int& removed) {
+        /*
+            Conta (simulate) ou cria os atalhos necessários para remover v:
+            para cada par u->v->w sem caminho testemunha tão curto quanto.
+        */
+        int shortcuts = 0;
+        removed = 0;
+        int max_out = 0;
+        for (const chArc& e : out[v]) if (!contracted[e.other]) { removed++; max_out = max(max_out, e.peso); }
+        for (const chArc& e : in[v]) if (!contracted[e.other]) removed++;
+        for (const chArc& ei : in[v]) {
+            int u = ei.other;
+            if (contracted[u]) continue;
+            this->witness(u, v, ei.peso + max_out, max_settled);
+            for (const chArc& eo : out[v]) {
+                int w = eo.other;
+                if (contracted[w] || w == u) continue;
+                int via = ei.peso + eo.peso;
+                if (mark[w] == generation && dist[w] <= via) continue;
+                shortcuts++;
+                if (!simulate) this->addArc(u, w, via, v);
+            }
+        }
+        return shortcuts;
+    }
+
+    int priority(int v, int max_settled) {
+        int removed;
+        int s = this->contract(v, max_settled, true, removed);
+        return s - removed + deleted_neighbors[v];
+    }
+};
+
+}
+
+void contractionHierarchy::build(const graph& G) {
+    /*
+        Contrai os nós em ordem crescente de prioridade (diferença de arcos
+        mais vizinhos já contraídos), com atualização preguiçosa: a
+        prioridade do topo da fila é recalculada antes de contrair.
+    */
+    auto t0 = chrono::steady_clock::now();
+    const int n = G.size();
+    chBuilder B;
+    B.out.assign(n, vector<chArc>());
+    B.in.assign(n, vector<chArc>());
+    B.contracted.assign(n, 0);
+    B.deleted_neighbors.assign(n, 0);
+    B.dist.assign(n, 0);
+    B.mark.assign(n, 0);
+    for (int u = 0; u < n; ++u)
+        for (const arc& e : G.a[u])
+            if (e.to != u) B.addArc(u, e.to, e.peso, -1);
+
+    this->rank.assign(n, -1);
+    this->up.assign(n, vector<chArc>());
+    this->down.assign(n, vector<chArc>());
+    this->num_shortcuts = 0;
+
+    priority_queue<PairInt, vector<PairInt>, greater<PairInt>> pq;
+    for (int v = 0; v < n; ++v)
+        pq.push({B.priority(v, this->witness_limit), v});
+
+    int next_rank = 0;
+    while (!pq.empty()) {
+        int v = pq.top().second;
+        pq.pop();
+        if (B.contracted[v]) continue;
+        int p = B.priority(v, this->witness_limit);
+        if (!pq.empty() && p > pq.top().first) {
+            pq.push({p, v});
+            continue;
+        }
+
+        // Os arcos restantes de v vão todos para nós de rank maior
+        for (const chArc& e : B.out[v]) if (!B.contracted[e.other]) this->up[v].push_back(e);
+        for (const chArc& e : B.in[v]) if (!B.contracted[e.other]) this->down[v].push_back(e);
+
+        int removed;
+        this->num_shortcuts += B.contract(v, this->witness_limit, false, removed);
+        B.contracted[v] = 1;
+        this->rank[v] = next_rank++;
+        for (const chArc& e : B.out[v]) B.deleted_neighbors[e.other]++;
+        for (const chArc& e : B.in[v]) B.deleted_neighbors[e.other]++;
+        // Libera a memória dos arcos de v, que não serão mais usados
+        vector<chArc>().swap(B.out[v]);
+        vector<chArc>().swap(B.in[v]);
+    }
+
+    for (int k = 0; k < 2; ++k) {
+        this->dist[k].assign(n, INF);
+        this->parent[k].assign(n, -1);
+        this->parent_meio[k].assign(n, -1);
+        this->mark[k].assign(n, 0);
+    }
+    this->generation = 0;
+    this->build_seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Consulta
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+int contractionHierarchy::search(int s, int t, int& meeting) {
+    /*
+        Dijkstra bidirecional: para frente em 'up' a partir de s e para trás
+        em 'down' a partir de t, ambos só subindo de rank. Para quando o
+        menor rótulo das duas filas não pode mais melhorar a melhor
+        distância encontrada.
+    */
+    if (++this->generation == 0) {
+        fill(this->mark[0].begin(), this->mark[0].end(), 0);
+        fill(this->mark[1].begin(), this->mark[1].end(), 0);
+        this->generation = 1;
+    }
+    priority_queue<PairInt, vector<PairInt>, greater<PairInt>> pq[2];
+    int src[2] = {s, t};
+    for (int k = 0; k < 2; ++k) {
+        this->dist[k][src[k]] = 0;
+        this->parent[k][src[k]] = -1;
+        this->mark[k][src[k]] = this->generation;
+        pq[k].push({0, src[k]});
+    }
+    int best = INF;
+    meeting = -1;
+    while (!pq[0].empty() || !pq[1].empty()) {
+        int k;
+        if (pq[0].empty()) k = 1;
+        else if (pq[1].empty()) k = 0;
+        else k = pq[0].top().first <= pq[1].top().first ? 0 : 1;
+        int d = pq[k].top().first, u = pq[k].top().second;
+        if (d >= best) {
+            // Esta direção não melhora mais; descarta a fila
+            pq[k] = priority_queue<PairInt, vector<PairInt>, greater<PairInt>>();
+            continue;
+        }
+        pq[k].pop();
+        if (d > this->dist[k][u]) continue;
+        if (this->mark[1 - k][u] == this->generation) {
+            int total = d + this->dist[1 - k][u];
+            if (total < best) { best = total; meeting = u; }
+        }
+        const vector<chArc>& adj = (k == 0) ? this->up[u] : this->down[u];
+        for (const chArc& e : adj) {
+            int v = e.other;
+            int nd = d + e.peso;
+            if (this->mark[k][v] != this->generation || nd < this->dist[k][v]) {
+                this->mark[k][v] = this->generation;
+                this->dist[k][v] = nd;
+                this->parent[k][v] = u;
+                this->parent_meio[k][v] = e.meio;
+                pq[k].push({nd, v});
+            }
+        }
+    }
+    return best;
+}
+
+int contractionHierarchy::distance(int start_node_idx, int end_node_idx) {
+    /*
+        Distância mínima, ou numeric_limits<int>::max() se não houver caminho.
+    */
+    int n = this->rank.size();
+    if (start_node_idx < 0 || start_node_idx >= n || end_node_idx < 0 || end_node_idx >= n)
+        return INF;
+    int meeting;
+    return this->search(start_node_idx, end_node_idx, meeting);
+}
+
+int contractionHierarchy::findMeio(int from, int to) const {
+    /*
+        Nó do meio do arco from->to. O arco está em up[from] se from tem rank
+        menor, senão em down[to].
+    */
+    if (this->rank[from] < this->rank[to]) {
+        for (const chArc& e : this->up[from]) if (e.other == to) return e.meio;
+    } else {
+        for (const chArc& e : this->down[to]) if (e.other == from) return e.meio;
+    }
+    return -1;
+}
+
+void contractionHierarchy::unpack(int from, int to, int meio, vector<int>& path) const {
+    /*
+        Expande o arco from->to em arcos originais, anexando os nós depois
+        de from (from já está no caminho).
+    */
+    if (meio == -1) {
+        path.push_back(to);
+        return;
+    }
+    this->unpack(from, meio, this->findMeio(from, meio), path);
+    this->unpack(meio, to, this->findMeio(meio, to), path);
+}
+
+vector<int> contractionHierarchy::query(int start_node_idx, int end_node_idx) {
+    /*
+        Mesmo contrato de graph::dijkstra: caminho de nós do início ao fim,
+        vazio se não houver caminho.
+    */
+    vector<int> path;
+    int n = this->rank.size();
+    if (start_node_idx < 0 || start_node_idx >= n || end_node_idx < 0 || end_node_idx >= n) {
+        cerr << "Erro: Indice de no inicial ou final invalido na consulta CH." << endl;
+        return path;
+    }
+    if (start_node_idx == end_node_idx) {
+        path.push_back(start_node_idx);
+        return path;
+    }
+    int meeting;
+    if (this->search(start_node_idx, end_node_idx, meeting) == INF)
+        return path;
+
+    // Metade para frente: de s até o encontro (pais invertidos)
+    vector<int> fwd, fwd_meio;
+    for (int v = meeting; v != start_node_idx; v = this->parent[0][v]) {
+        fwd.push_back(v);
+        fwd_meio.push_back(this->parent_meio[0][v]);
+    }
+    path.push_back(start_node_idx);
+    int prev = start_node_idx;
+    for (int k = (int)fwd.size() - 1; k >= 0; --k) {
+        this->unpack(prev, fwd[k], fwd_meio[k], path);
+        prev = fwd[k];
+    }
+    // Metade para trás: do encontro até t seguindo os pais da busca reversa
+    for (int v = meeting; v != end_node_idx; ) {
+        int next = this->parent[1][v];
+        this->unpack(v, next, this->parent_meio[1][v], path);
+        v = next;
+    }
+    return path;
+}
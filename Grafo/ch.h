@@ -0,0 +1,48 @@
+#ifndef CH_H
+#define CH_H
+
+#include "graph.h"
+#include <vector>
+
+using namespace std;
+
+// Arco da hierarquia: original (meio == -1) ou atalho que substitui
+// os arcos from->meio e meio->to.
+struct chArc {
+    int other;
+    int peso;
+    int meio;
+};
+
+// Hierarquia de contração sobre os pesos (arc::peso) de um grafo que muda
+// pouco. Os nós são contraídos em ordem de importância (diferença de arcos)
+// e cada contração adiciona os atalhos necessários para preservar as
+// distâncias. As consultas são buscas de Dijkstra bidirecionais que só
+// sobem na hierarquia.
+class contractionHierarchy {
+public:
+    vector<int> rank;                  // posição de cada nó na ordem de contração
+    vector< vector<chArc> > up;        // arcos v->w com rank[w] > rank[v]
+    vector< vector<chArc> > down;      // arcos u->v com rank[u] > rank[v] (guardados em v)
+    int num_shortcuts = 0;
+    double build_seconds = 0.0;
+    int witness_limit = 200;          // nós assentados por busca de testemunha
+
+    void build(const graph& G);
+    int distance(int start_node_idx, int end_node_idx);
+    vector<int> query(int start_node_idx, int end_node_idx);
+
+private:
+    // Área de trabalho da consulta, reutilizada (marcas por geração)
+    vector<int> dist[2];
+    vector<int> parent[2];
+    vector<int> parent_meio[2];
+    vector<unsigned int> mark[2];
+    unsigned int generation = 0;
+
+    int search(int s, int t, int& meeting);
+    int findMeio(int from, int to) const;
+    void unpack(int from, int to, int meio, vector<int>& path) const;
+};
+
+#endif
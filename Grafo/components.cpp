@@ -0,0 +1,463 @@
+#include "graph.h"
+#include "parallel.h"
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Componentes fracamente conexas (Afforest)
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+static void linkAfforest(vector< atomic<int> >& comp, int u, int v) {
+    /*
+        Une as árvores de u e v, sempre apontando a raiz maior para a menor.
+        O CAS garante que duas threads não sobrescrevam a mesma raiz.
+    */
+    int p1 = comp[u].load(memory_order_relaxed);
+    int p2 = comp[v].load(memory_order_relaxed);
+    while (p1 != p2) {
+        int high = max(p1, p2);
+        int low = min(p1, p2);
+        int p_high = comp[high].load(memory_order_relaxed);
+        if (p_high == low)
+            break;
+        if (p_high == high && comp[high].compare_exchange_strong(p_high, low))
+            break;
+        p1 = comp[comp[high].load(memory_order_relaxed)].load(memory_order_relaxed);
+        p2 = comp[low].load(memory_order_relaxed);
+    }
+}
+
+static void compressAfforest(vector< atomic<int> >& comp, int threads) {
+    parallelFor(threads, (int)comp.size(), [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) {
+            while (comp[u].load(memory_order_relaxed) !=
+                   comp[comp[u].load(memory_order_relaxed)].load(memory_order_relaxed)) {
+                comp[u].store(comp[comp[u].load(memory_order_relaxed)].load(memory_order_relaxed),
+                              memory_order_relaxed);
+            }
+        }
+    });
+}
+
+static void weakComponents(const graph& G, int threads, vector<int>& out) {
+    /*
+        Afforest: liga primeiro poucos vizinhos de cada nó, identifica a maior
+        componente por amostragem e só processa o restante das arestas dos nós
+        fora dela. Como o grafo é dirigido, os nós fora da componente grande
+        também ligam seus arcos de entrada.
+    */
+    const int n = G.size();
+    const int rounds = 2;
+    vector< atomic<int> > comp(n);
+    for (int u = 0; u < n; ++u)
+        comp[u].store(u, memory_order_relaxed);
+
+    for (int r = 0; r < rounds; ++r) {
+        parallelFor(threads, n, [&](int b, int e, int) {
+            for (int u = b; u < e; ++u) {
+                if (r < (int)G.a[u].size())
+                    linkAfforest(comp, u, G.a[u][r].to);
+            }
+        });
+        compressAfforest(comp, threads);
+    }
+
+    // Amostra a componente mais frequente
+    int frequent = 0;
+    if (n > 0) {
+        vector<int> sample;
+        unsigned int x = 2463534242u;
+        const int samples = min(n, 1024);
+        for (int k = 0; k < samples; ++k) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            sample.push_back(comp[x % n].load(memory_order_relaxed));
+        }
+        sort(sample.begin(), sample.end());
+        int best = 0;
+        for (size_t i = 0; i < sample.size();) {
+            size_t j = i;
+            while (j < sample.size() && sample[j] == sample[i]) ++j;
+            if ((int)(j - i) > best) { best = j - i; frequent = sample[i]; }
+            i = j;
+        }
+    }
+
+    parallelFor(threads, n, [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) {
+            if (comp[u].load(memory_order_relaxed) == frequent)
+                continue;
+            for (size_t k = rounds; k < G.a[u].size(); ++k)
+                linkAfforest(comp, u, G.a[u][k].to);
+            for (const arc& e_in : G.inNeighbors(u))
+                linkAfforest(comp, u, e_in.from);
+        }
+    });
+    compressAfforest(comp, threads);
+
+    out.resize(n);
+    for (int u = 0; u < n; ++u)
+        out[u] = comp[u].load(memory_order_relaxed);
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Componentes fortemente conexas e DAG de condensação
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void componentIndex::build(const graph& G, int threads) {
+    /*
+        Constrói o índice completo. Como toda componente forte está contida em
+        uma componente fraca, as componentes fracas são distribuídas entre as
+        threads e cada uma roda um Tarjan iterativo (linear) restrito a ela.
+        O Tarjan numera as componentes fortes em ordem topológica reversa, o
+        que permite calcular os níveis do DAG na mesma passada.
+    */
+    if (threads > 0) this->threads = threads;
+    threads = defaultThreads(this->threads);
+    const int n = G.size();
+
+    // Sai achatado: cada entrada já é o rótulo da raiz, então as consultas
+    // acham a componente com uma leitura até o próximo arcAppend
+    weakComponents(G, threads, this->wcc);
+
+    // Agrupa os nós por componente fraca (ordenação por contagem)
+    vector<int> comp_id(n, -1);
+    int num_comp = 0;
+    for (int u = 0; u < n; ++u)
+        if (this->wcc[u] == u) comp_id[u] = num_comp++;
+    vector<int> start(num_comp + 1, 0);
+    for (int u = 0; u < n; ++u) start[comp_id[this->wcc[u]] + 1]++;
+    this->wcc_size.assign(n, 1);
+    for (int u = 0; u < n; ++u)
+        if (this->wcc[u] == u) this->wcc_size[u] = start[comp_id[u] + 1];
+    for (int k = 0; k < num_comp; ++k) start[k + 1] += start[k];
+    vector<int> members(n);
+    {
+        vector<int> pos(start.begin(), start.end() - 1);
+        for (int u = 0; u < n; ++u) members[pos[comp_id[this->wcc[u]]]++] = u;
+    }
+
+    // Componentes grandes primeiro, para equilibrar a carga
+    vector<int> schedule(num_comp);
+    for (int k = 0; k < num_comp; ++k) schedule[k] = k;
+    sort(schedule.begin(), schedule.end(), [&](int x, int y) {
+        return start[x + 1] - start[x] > start[y + 1] - start[y];
+    });
+
+    this->scc.assign(n, -1);
+    vector<int> order(n);          // nós agrupados por componente forte local
+    vector<int> scc_count(num_comp, 0);
+    vector<int> idx(n, -1), low(n, 0);
+    vector<char> on_stack(n, 0);
+
+    atomic<int> next(0);
+    parallelRun(min(threads, max(1, num_comp)), [&](int) {
+        vector<int> stack;
+        vector< pair<int, int> > call;   // (nó, próximo arco)
+        int k;
+        while ((k = next.fetch_add(1)) < num_comp) {
+            int c = schedule[k];
+            int counter = 0, local = 0, out = start[c];
+            for (int m = start[c]; m < start[c + 1]; ++m) {
+                int root = members[m];
+                if (idx[root] != -1) continue;
+                call.push_back({root, 0});
+                idx[root] = low[root] = counter++;
+                stack.push_back(root);
+                on_stack[root] = 1;
+                while (!call.empty()) {
+                    int u = call.back().first;
+                    int& p = call.back().second;
+                    if (p < (int)G.a[u].size()) {
+                        int v = G.a[u][p++].to;
+                        if (idx[v] == -1) {
+                            idx[v] = low[v] = counter++;
+                            stack.push_back(v);
+                            on_stack[v] = 1;
+                            call.push_back({v, 0});
+                        } else if (on_stack[v]) {
+                            low[u] = min(low[u], idx[v]);
+                        }
+                        continue;
+                    }
+                    call.pop_back();
+                    if (!call.empty())
+                        low[call.back().first] = min(low[call.back().first], low[u]);
+                    if (low[u] == idx[u]) {
+                        int w;
+                        do {
+                            w = stack.back();
+                            stack.pop_back();
+                            on_stack[w] = 0;
+                            this->scc[w] = local;
+                            order[out++] = w;
+                        } while (w != u);
+                        local++;
+                    }
+                }
+            }
+            scc_count[c] = local;
+        }
+    });
+
+    vector<int> offset(num_comp + 1, 0);
+    for (int c = 0; c < num_comp; ++c) offset[c + 1] = offset[c] + scc_count[c];
+    this->num_wcc = num_comp;
+    this->num_scc = offset[num_comp];
+    this->level.assign(this->num_scc, 0);
+    this->dag.assign(this->num_scc, vector<int>());
+
+    next.store(0);
+    parallelRun(min(threads, max(1, num_comp)), [&](int) {
+        int k;
+        while ((k = next.fetch_add(1)) < num_comp) {
+            int c = schedule[k];
+            for (int m = start[c]; m < start[c + 1]; ++m)
+                this->scc[order[m]] += offset[c];
+            // Ordem topológica = ids locais decrescentes = 'order' de trás pra frente
+            for (int m = start[c + 1] - 1; m >= start[c]; --m) {
+                int u = order[m];
+                int su = this->scc[u];
+                for (const arc& e : G.a[u]) {
+                    int sv = this->scc[e.to];
+                    if (sv == su) continue;
+                    this->level[sv] = max(this->level[sv], this->level[su] + 1);
+                    this->dag[su].push_back(sv);
+                }
+            }
+            for (int s = offset[c]; s < offset[c + 1]; ++s) {
+                sort(this->dag[s].begin(), this->dag[s].end());
+                this->dag[s].erase(unique(this->dag[s].begin(), this->dag[s].end()),
+                                   this->dag[s].end());
+            }
+        }
+    });
+
+    this->scc_rep.resize(this->num_scc);
+    for (int s = 0; s < this->num_scc; ++s) this->scc_rep[s] = s;
+    this->scc_size.assign(this->num_scc, 0);
+    for (int u = 0; u < n; ++u) this->scc_size[this->scc[u]]++;
+    this->mark.assign(this->num_scc, 0);
+    this->reach.assign(this->num_scc, 0);
+    this->generation = 0;
+    this->arcs = 0;
+    for (int u = 0; u < n; ++u) this->arcs += G.a[u].size();
+
+    this->enabled = true;
+    this->stale = false;
+    this->stale_arcs = 0;
+}
+
+/*------------------------------------------------------------------------------
+    Atualização incremental
+------------------------------------------------------------------------------*/
+
+void componentIndex::onNodeAppend() {
+    /*
+        Um nó novo é uma componente fraca e forte isolada, no nível 0. Ids de
+        componentes fortes fundidas não são reaproveitados.
+    */
+    int s = this->level.size();
+    this->wcc.push_back(this->wcc.size());
+    this->wcc_size.push_back(1);
+    this->scc.push_back(s);
+    this->scc_rep.push_back(s);
+    this->scc_size.push_back(1);
+    this->level.push_back(0);
+    this->dag.push_back(vector<int>());
+    this->mark.push_back(0);
+    this->reach.push_back(0);
+    this->num_wcc++;
+    this->num_scc++;
+}
+
+int componentIndex::findWcc(int u) {
+    while (this->wcc[u] != u) {
+        this->wcc[u] = this->wcc[this->wcc[u]];   // compressão por halving
+        u = this->wcc[u];
+    }
+    return u;
+}
+
+int componentIndex::wccLabel(int u) const {
+    /*
+        Busca sem compressão: não escreve no índice, então pode ser usada
+        por várias threads ao mesmo tempo. Logo após build a floresta é
+        plana; depois a união por tamanho mantém a altura em O(log n).
+    */
+    while (this->wcc[u] != u)
+        u = this->wcc[u];
+    return u;
+}
+
+int componentIndex::findScc(int s) {
+    while (this->scc_rep[s] != s) {
+        this->scc_rep[s] = this->scc_rep[this->scc_rep[s]];
+        s = this->scc_rep[s];
+    }
+    return s;
+}
+
+int componentIndex::sccLabel(int s) const {
+    while (this->scc_rep[s] != s)
+        s = this->scc_rep[s];
+    return s;
+}
+
+bool componentIndex::raiseLevels(int s, size_t first, long long& budget) {
+    /*
+        Restaura level[x] < level[y] nos arcos a jusante de s, subindo só as
+        componentes que violam a ordem; em s só olha os arcos a partir de
+        first. Retorna falso se o orçamento de arcos acabar no meio.
+    */
+    this->work.clear();
+    this->work.push_back(s);
+    while (!this->work.empty()) {
+        int x = this->work.back();
+        this->work.pop_back();
+        vector<int>& d = this->dag[x];
+        for (size_t i = (x == s ? first : 0); i < d.size(); ++i) {
+            if (--budget < 0) return false;
+            int y = d[i] = this->findScc(d[i]);
+            if (y != x && this->level[y] <= this->level[x]) {
+                this->level[y] = this->level[x] + 1;
+                this->work.push_back(y);
+            }
+        }
+    }
+    return true;
+}
+
+void componentIndex::onArcAppend(int from, int to) {
+    /*
+        Componentes fracas: union-find com união por tamanho. Componentes
+        fortes: um arco sf -> st com level[sf] < level[st] só entra no DAG.
+        Caso contrário (Pearce-Kelly com níveis), uma DFS a partir de st
+        restrita a níveis <= level[sf] acha todo caminho st ~> sf, já que os
+        níveis crescem ao longo dos caminhos. Se não há caminho, basta subir
+        st acima de sf e propagar. Se há, as componentes que estão nesses
+        caminhos formam um ciclo com o arco novo e são fundidas numa só, com
+        o nível de sf (o maior entre elas).
+        Cada correção percorre no máximo ~arcs/64 arcos do DAG; se passar
+        disso o índice fica stale até graph::arcAppend reconstruí-lo.
+    */
+    this->arcs++;
+    int rf = this->findWcc(from), rt = this->findWcc(to);
+    if (rf != rt) {
+        if (this->wcc_size[rf] < this->wcc_size[rt]) swap(rf, rt);
+        this->wcc[rt] = rf;
+        this->wcc_size[rf] += this->wcc_size[rt];
+        this->num_wcc--;
+    }
+    if (this->stale) {
+        this->stale_arcs++;
+        return;
+    }
+    int sf = this->findScc(this->scc[from]), st = this->findScc(this->scc[to]);
+    if (sf == st) return;
+    this->dag[sf].push_back(st);
+    if (this->level[sf] < this->level[st]) return;
+
+    long long budget = 1024 + this->arcs / 64;
+
+    // DFS em pós-ordem a partir de st, sem expandir sf
+    const int limite = this->level[sf];
+    if (++this->generation == 0) {
+        fill(this->mark.begin(), this->mark.end(), 0);
+        this->generation = 1;
+    }
+    this->region.clear();
+    this->call.clear();
+    this->mark[st] = this->generation;
+    this->call.push_back(make_pair(st, 0));
+    while (!this->call.empty()) {
+        int x = this->call.back().first;
+        int& k = this->call.back().second;
+        if (x != sf && k < (int)this->dag[x].size()) {
+            if (--budget < 0) {
+                this->stale = true;
+                return;
+            }
+            int y = this->findScc(this->dag[x][k++]);
+            if (this->mark[y] != this->generation && this->level[y] <= limite) {
+                this->mark[y] = this->generation;
+                this->call.push_back(make_pair(y, 0));
+            }
+            continue;
+        }
+        // Todos os filhos de x já terminaram: x alcança sf se algum deles alcança
+        char r = (x == sf);
+        for (int i = 0; !r && x != sf && i < (int)this->dag[x].size(); ++i) {
+            int y = this->findScc(this->dag[x][i]);
+            r = y != x && this->mark[y] == this->generation && this->reach[y];
+        }
+        this->reach[x] = r;
+        this->region.push_back(x);
+        this->call.pop_back();
+    }
+
+    if (!this->reach[st]) {
+        this->level[st] = this->level[sf] + 1;
+        if (!this->raiseLevels(st, 0, budget)) this->stale = true;
+        return;
+    }
+
+    // Funde o ciclo na maior componente dele (união por tamanho). Os arcos
+    // das demais são anexados sem ordenar; ids fundidos e laços são
+    // resolvidos quando percorridos.
+    int rep = sf;
+    for (int x : this->region)
+        if (this->reach[x] && this->scc_size[x] > this->scc_size[rep]) rep = x;
+    size_t first = rep == sf ? this->dag[rep].size() : 0;
+    for (int x : this->region) {
+        if (!this->reach[x] || x == rep) continue;
+        this->scc_rep[x] = rep;
+        this->scc_size[rep] += this->scc_size[x];
+        this->dag[rep].insert(this->dag[rep].end(), this->dag[x].begin(), this->dag[x].end());
+        vector<int>().swap(this->dag[x]);
+        this->num_scc--;
+    }
+    // Com rep == sf o nível não muda e só os arcos anexados precisam de conferência
+    this->level[rep] = limite;
+    if (!this->raiseLevels(rep, first, budget)) this->stale = true;
+}
+
+bool componentIndex::mayReach(int u, int v) const {
+    /*
+        Falso apenas se for garantido que u não alcança v. Com o índice
+        stale só as componentes fracas, sempre em dia, são consultadas.
+    */
+    if (u == v) return true;
+    if (this->wccLabel(u) != this->wccLabel(v)) return false;
+    if (this->stale) return true;
+    int su = this->sccLabel(this->scc[u]), sv = this->sccLabel(this->scc[v]);
+    if (su == sv) return true;
+    return this->level[su] < this->level[sv];
+}
+
+bool componentIndex::needsRebuild() const {
+    /*
+        Reconstruir custa O(n + m); esperar m/8 arcos depois de ficar stale
+        mantém o custo amortizado constante por arco.
+    */
+    return this->stale && this->stale_arcs >= max(1024LL, this->arcs / 8);
+}
+
+/*------------------------------------------------------------------------------
+    Funções de grafo
+------------------------------------------------------------------------------*/
+
+void graph::buildComponentIndex(int threads) {
+    this->comp.build(*this, threads);
+}
+
+bool graph::mayReach(int start_node_idx, int end_node_idx) const {
+    if (!this->comp.enabled) return true;
+    return this->comp.mayReach(start_node_idx, end_node_idx);
+}
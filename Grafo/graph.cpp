@@ -7,6 +7,7 @@
 #include <limits>   
 #include <new> 
 #include <exception> 
+#include <functional>
 
 using namespace std;
 /*------------------------------------------------------------------------------
@@ -41,15 +42,33 @@ int graph::size() const {
     return this->nd.size();
 }
 
+void graph::clear(){
+    /*
+        Remove todos os nós, arcos e índices do grafo.
+    */
+    this->nd.clear();
+    this->a.clear();
+    this->in.clear();
+    this->index.clear();
+    this->hierarchical_verbs.clear();
+    this->comp = componentIndex();
+}
+
 bool graph::nodeIsIn(string S){
     /*
         Checa se existe algum nó com a string S.
     */
-    for (size_t i=0; i<this->nd.size(); i++){ 
-        if (this->nd[i]==S)
-            return true;
-    }
-    return false;
+    return this->index.count(S) > 0;
+}
+
+int graph::nodeIndex(const string& S) const {
+    /*
+        Retorna o índice do nó com a string S, ou -1 se não existir.
+    */
+    auto it = this->index.find(S);
+    if (it == this->index.end())
+        return -1;
+    return it->second;
 }
 
 void graph::nodeAppend(string S){
@@ -57,61 +76,79 @@ void graph::nodeAppend(string S){
         Anexa novo nó, caso ainda não tenha sido adicionado.
     */
     if (!this->nodeIsIn(S)){
-        node* n = new node;
-        n->substantivo = S;
-        this->nd.push_back(*n);
-        vector<arc> v_arc;
-        this->a.push_back(v_arc);
+        node n;
+        n.substantivo = S;
+        this->index[S] = this->nd.size();
+        this->nd.push_back(n);
+        this->a.push_back(vector<arc>());
+        this->in.push_back(vector<arcRef>());
+        if (this->comp.enabled)
+            this->comp.onNodeAppend();
     }
 }
 
-void graph::arcAppend(string S1, string V, string S2){
+void graph::arcAppend(string S1, string V, string S2, int peso){
     /*
         Insere novo arco.
-        S1 e S2 são os substantivos envolvidos e V é o verbo.
+        S1 e S2 são os substantivos envolvidos, V é o verbo e peso é o custo
+        do arco nos caminhos mínimos (1 por padrão).
     */
-    arc* new_arc = new arc;
-    new_arc->verbo = V;
-    int pos_S1 = -1; 
-    int pos_S2 = -1;
-
-    // Encontrar os índices dos nó
-    for (size_t k=0; k<this->size(); k++){ 
-        if (this->nd[k]==S1){
-            pos_S1 = k;
-        }
-        if (this->nd[k]==S2){
-            pos_S2 = k;
-        }
-        if (pos_S1 != -1 && pos_S2 != -1) break;
-    }
+    int pos_S1 = this->nodeIndex(S1);
+    int pos_S2 = this->nodeIndex(S2);
     
     // Apenas adiciona o arco se ambos os nó existirem
     if (pos_S1 != -1 && pos_S2 != -1) {
-        new_arc->from = pos_S1;
-        new_arc->to = pos_S2;
-        this->a[pos_S1].push_back(*new_arc);
-    } else {
-        delete new_arc; 
+        arc new_arc;
+        new_arc.verbo = V;
+        new_arc.from = pos_S1;
+        new_arc.to = pos_S2;
+        new_arc.peso = peso;
+        this->in[pos_S2].push_back(arcRef{pos_S1, (int)this->a[pos_S1].size()});
+        this->a[pos_S1].push_back(new_arc);
+        if (this->comp.enabled) {
+            this->comp.onArcAppend(pos_S1, pos_S2);
+            if (this->comp.needsRebuild())
+                this->comp.build(*this);
+        }
     }
 }
 
+const string& graph::noun(int idx) const {
+    return this->nd[idx].substantivo;
+}
+
+arcSpan graph::neighbors(int idx) const {
+    /*
+        Arcos que partem do nó idx, sem cópia.
+    */
+    const vector<arc>& v = this->a[idx];
+    return arcSpan{v.data(), v.data() + v.size()};
+}
+
+inArcSpan graph::inNeighbors(int idx) const {
+    /*
+        Arcos que chegam ao nó idx, sem cópia.
+    */
+    const vector<arcRef>& v = this->in[idx];
+    return inArcSpan{&this->a, v.data(), v.data() + v.size()};
+}
+
 void graph::printRelations(string S){
     /*
         Imprime as relações que partem da string S.
     */
-    for (size_t k=0; k<this->size(); k++){ 
-        if (this->nd[k]==S){
-            cout << "Relações para " << this->nd[k].substantivo << ":" << endl;
-            for (size_t p=0; p<this->a[k].size(); p++){ 
-                cout << this->nd[this->a[k][p].from].substantivo << " ";
-                cout << this->a[k][p].verbo << " ";
-                cout << this->nd[this->a[k][p].to].substantivo << endl;
-            }
-            return;
-        }
-    }
-    cout << "String não encontrada!";
+    int k = this->nodeIndex(S);
+    if (k == -1){
+        cout << "String não encontrada!";
+        return;
+    }
+    cout << "Relações para " << this->nd[k].substantivo << ":" << '\n';
+    for (const arc& e : this->neighbors(k)){ 
+        cout << this->nd[e.from].substantivo << " ";
+        cout << e.verbo << " ";
+        cout << this->nd[e.to].substantivo << '\n';
+    }
+    cout.flush();
 }
 
 void graph::printSubs(){
@@ -119,8 +156,9 @@ void graph::printSubs(){
         Imprime substantivos.
     */
     for (size_t k=0; k<this->size(); k++){ 
-        cout << this->nd[k].substantivo << endl;
+        cout << this->nd[k].substantivo << '\n';
     }
+    cout.flush();
 }
 
 void graph::load(ifstream& F){
@@ -140,6 +178,104 @@ void graph::addHierarchicalVerb(string verb) {
     this->hierarchical_verbs.insert(verb);
 }
 
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Escrita bufferizada de relações
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+relationWriter::relationWriter(ostream& out, relationFormat fmt, size_t capacity)
+    : out(out), fmt(fmt), capacity(capacity) {
+    this->buf.reserve(capacity + 256);
+}
+
+relationWriter::~relationWriter(){
+    this->flush();
+}
+
+void relationWriter::appendField(const string& S){
+    /*
+        Anexa um campo ao buffer, escapando caracteres especiais do formato.
+    */
+    if (this->fmt == REL_TSV){
+        for (char c : S){
+            if (c == '\t')      this->buf += "\\t";
+            else if (c == '\n') this->buf += "\\n";
+            else if (c == '\\') this->buf += "\\\\";
+            else                this->buf += c;
+        }
+        return;
+    }
+    this->buf += '"';
+    for (char c : S){
+        switch (c){
+            case '"':  this->buf += "\\\""; break;
+            case '\\': this->buf += "\\\\"; break;
+            case '\n': this->buf += "\\n"; break;
+            case '\t': this->buf += "\\t"; break;
+            case '\r': this->buf += "\\r"; break;
+            default:
+                if ((unsigned char)c < 0x20){
+                    static const char hex[] = "0123456789abcdef";
+                    this->buf += "\\u00";
+                    this->buf += hex[(c >> 4) & 0xF];
+                    this->buf += hex[c & 0xF];
+                } else {
+                    this->buf += c; // UTF-8 passa sem alteração
+                }
+        }
+    }
+    this->buf += '"';
+}
+
+void relationWriter::write(const graph& G, const arc& e){
+    /*
+        Formata uma relação (sujeito, verbo, objeto) no buffer.
+    */
+    if (this->fmt == REL_TSV){
+        this->appendField(G.noun(e.from));
+        this->buf += '\t';
+        this->appendField(e.verbo);
+        this->buf += '\t';
+        this->appendField(G.noun(e.to));
+        this->buf += '\n';
+    } else {
+        this->buf += "{\"sujeito\":";
+        this->appendField(G.noun(e.from));
+        this->buf += ",\"verbo\":";
+        this->appendField(e.verbo);
+        this->buf += ",\"objeto\":";
+        this->appendField(G.noun(e.to));
+        this->buf += "}\n";
+    }
+    if (this->buf.size() >= this->capacity)
+        this->flush();
+}
+
+void relationWriter::writeRelations(const graph& G, int node_idx){
+    /*
+        Escreve todas as relações que partem do nó node_idx.
+    */
+    for (const arc& e : G.neighbors(node_idx))
+        this->write(G, e);
+}
+
+void relationWriter::writeIncoming(const graph& G, int node_idx){
+    /*
+        Escreve todas as relações que chegam ao nó node_idx.
+    */
+    for (const arc& e : G.inNeighbors(node_idx))
+        this->write(G, e);
+}
+
+void relationWriter::flush(){
+    if (!this->buf.empty()){
+        this->out.write(this->buf.data(), this->buf.size());
+        this->buf.clear();
+    }
+    this->out.flush();
+}
+
 /*------------------------------------------------------------------------------
 ------------------------------------------------------------------------------*/
 
@@ -220,6 +356,11 @@ vector<int> graph::bfs(int start_node_idx, int end_node_idx) {
         return path; 
     }
 
+    // Rejeição em O(1) de pares que não se alcançam
+    if (this->comp.enabled && !this->mayReach(start_node_idx, end_node_idx)) {
+        return path;
+    }
+
     bool* visited = nullptr; 
     try {
         visited = new bool[this->size()]; 
@@ -365,6 +506,11 @@ vector<int> graph::bfsHierarchical(int start_node_idx, int end_node_idx) {
         return path;
     }
 
+    // Rejeição em O(1) de pares que não se alcançam
+    if (this->comp.enabled && !this->mayReach(start_node_idx, end_node_idx)) {
+        return path;
+    }
+
     // visited array para controle de nós já visitados
     bool* visited = nullptr; 
     try {
@@ -546,6 +692,11 @@ vector<int> graph::dijkstra(int start_node_idx, int end_node_idx) {
         return path;
     }
 
+    // Rejeição em O(1) de pares que não se alcançam
+    if (this->comp.enabled && !this->mayReach(start_node_idx, end_node_idx)) {
+        return path;
+    }
+
     // Vetores para armazenar distâncias e predecessores
     vector<int> dist(this->size(), numeric_limits<int>::max()); 
     vector<int> prev(this->size(), -1); 
@@ -577,7 +728,7 @@ vector<int> graph::dijkstra(int start_node_idx, int end_node_idx) {
 
             for (const auto& arc : this->a[u]) {
                 int v = arc.to; 
-                int weight = 1; // Para Dijkstra de caminho mais curto não ponderado, peso 1 é OK.
+                int weight = arc.peso; // 1 por padrão: caminho com menos arcos
 
                 if (v < 0 || v >= (int)this->size()) {
                     cerr << "ERRO: v fora dos limites para 'dist'/'prev': " << v << endl; // Reativado para debug
@@ -611,4 +762,136 @@ vector<int> graph::dijkstra(int start_node_idx, int end_node_idx) {
     reverse(path.begin(), path.end()); 
 
     return path;
-}
\ No newline at end of file
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Buscas com área de trabalho reutilizável
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+static bool beginSearch(const graph& G, int start_node_idx, int end_node_idx,
+                        searchWorkspace& W, const char* nome) {
+    /*
+        Valida os índices, prepara a área de trabalho e resolve os casos
+        triviais. Retorna falso quando a busca não precisa rodar; W.path já
+        contém a resposta.
+    */
+    const int n = G.size();
+    W.path.clear();
+    if (start_node_idx < 0 || start_node_idx >= n || end_node_idx < 0 || end_node_idx >= n) {
+        cerr << "Erro: Indice de no inicial ou final invalido " << nome << "." << endl;
+        return false;
+    }
+    if (start_node_idx == end_node_idx) {
+        W.path.push_back(start_node_idx);
+        return false;
+    }
+    // Rejeição em O(1) de pares que não se alcançam
+    if (!G.mayReach(start_node_idx, end_node_idx))
+        return false;
+
+    if ((int)W.mark.size() != n) {
+        W.mark.assign(n, 0);
+        W.dist.resize(n);
+        W.prev.resize(n);
+        W.generation = 0;
+    }
+    if (++W.generation == 0) {
+        fill(W.mark.begin(), W.mark.end(), 0);
+        W.generation = 1;
+    }
+    W.queue.clear();
+    W.heap.clear();
+    W.mark[start_node_idx] = W.generation;
+    W.dist[start_node_idx] = 0;
+    W.prev[start_node_idx] = -1;
+    return true;
+}
+
+static void buildPath(int end_node_idx, searchWorkspace& W) {
+    for (int v = end_node_idx; v != -1; v = W.prev[v])
+        W.path.push_back(v);
+    reverse(W.path.begin(), W.path.end());
+}
+
+const vector<int>& graph::bfs(int start_node_idx, int end_node_idx, searchWorkspace& W) const {
+    if (!beginSearch(*this, start_node_idx, end_node_idx, W, "na BFS"))
+        return W.path;
+    W.queue.push_back(start_node_idx);
+    for (size_t h = 0; h < W.queue.size(); ++h) {
+        int u = W.queue[h];
+        if (u == end_node_idx) {
+            buildPath(end_node_idx, W);
+            break;
+        }
+        for (const arc& e : this->a[u]) {
+            if (W.mark[e.to] == W.generation) continue;
+            W.mark[e.to] = W.generation;
+            W.prev[e.to] = u;
+            W.queue.push_back(e.to);
+        }
+    }
+    return W.path;
+}
+
+const vector<int>& graph::bfsHierarchical(int start_node_idx, int end_node_idx, searchWorkspace& W) const {
+    /*
+        Mesma ordem de visita da versão original: um arco hierárquico
+        também enfileira os alvos hierárquicos do vizinho, com o nó atual
+        como pai.
+    */
+    if (!beginSearch(*this, start_node_idx, end_node_idx, W, "na BFS Hierarquica"))
+        return W.path;
+    W.queue.push_back(start_node_idx);
+    for (size_t h = 0; h < W.queue.size(); ++h) {
+        int u = W.queue[h];
+        if (u == end_node_idx) {
+            buildPath(end_node_idx, W);
+            break;
+        }
+        for (const arc& e : this->a[u]) {
+            if (W.mark[e.to] != W.generation) {
+                W.mark[e.to] = W.generation;
+                W.prev[e.to] = u;
+                W.queue.push_back(e.to);
+            }
+            if (!this->hierarchical_verbs.count(e.verbo)) continue;
+            for (const arc& sub : this->a[e.to]) {
+                if (W.mark[sub.to] == W.generation || !this->hierarchical_verbs.count(sub.verbo))
+                    continue;
+                W.mark[sub.to] = W.generation;
+                W.prev[sub.to] = u;
+                W.queue.push_back(sub.to);
+            }
+        }
+    }
+    return W.path;
+}
+
+const vector<int>& graph::dijkstra(int start_node_idx, int end_node_idx, searchWorkspace& W) const {
+    if (!beginSearch(*this, start_node_idx, end_node_idx, W, "no Dijkstra"))
+        return W.path;
+    greater<PairInt> cmp;
+    W.heap.push_back(PairInt(0, start_node_idx));
+    while (!W.heap.empty()) {
+        pop_heap(W.heap.begin(), W.heap.end(), cmp);
+        int d = W.heap.back().first;
+        int u = W.heap.back().second;
+        W.heap.pop_back();
+        if (d > W.dist[u]) continue;
+        if (u == end_node_idx) break;
+        for (const arc& e : this->a[u]) {
+            int alt = W.dist[u] + e.peso;
+            if (W.mark[e.to] == W.generation && alt >= W.dist[e.to]) continue;
+            W.mark[e.to] = W.generation;
+            W.dist[e.to] = alt;
+            W.prev[e.to] = u;
+            W.heap.push_back(PairInt(alt, e.to));
+            push_heap(W.heap.begin(), W.heap.end(), cmp);
+        }
+    }
+    if (W.mark[end_node_idx] == W.generation)
+        buildPath(end_node_idx, W);
+    return W.path;
+}
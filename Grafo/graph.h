@@ -1,3 +1,6 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -5,6 +8,10 @@
 #include <set> 
 #include <queue> // NOVO: Para std::priority_queue
 #include <limits> // Para numeric_limits (infinito)
+#include <string>
+#include <unordered_map>
+#include <ostream>
+#include <atomic>
 
 using namespace std;
 
@@ -38,6 +45,157 @@ public:
     string verbo;
     int from;
     int to;
+    int peso = 1;   // custo do arco nos caminhos mínimos
+};
+
+// Referência a um arco de entrada: o arco a[from][pos] chega ao nó
+struct arcRef {
+    int from;
+    int pos;
+};
+
+// Visão leve (sem cópia) dos arcos de saída de um nó
+class arcSpan {
+public:
+    const arc* first;
+    const arc* last;
+
+    const arc* begin() const { return first; }
+    const arc* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const arc& operator[](size_t k) const { return first[k]; }
+};
+
+// Visão leve (sem cópia) dos arcos de entrada de um nó.
+// Cada arcRef é resolvido para o arco original em a[from][pos].
+class inArcSpan {
+public:
+    class iterator {
+    public:
+        const vector< vector<arc> >* a;
+        const arcRef* r;
+
+        const arc& operator*() const { return (*a)[r->from][r->pos]; }
+        const arc* operator->() const { return &(*a)[r->from][r->pos]; }
+        iterator& operator++() { ++r; return *this; }
+        bool operator!=(const iterator& o) const { return r != o.r; }
+        bool operator==(const iterator& o) const { return r == o.r; }
+    };
+
+    const vector< vector<arc> >* a;
+    const arcRef* first;
+    const arcRef* last;
+
+    iterator begin() const { return iterator{a, first}; }
+    iterator end() const { return iterator{a, last}; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const arc& operator[](size_t k) const { return (*a)[first[k].from][first[k].pos]; }
+};
+
+class graph;
+
+// Índice de componentes: componentes fracamente conexas (union-find),
+// componentes fortemente conexas e níveis topológicos do DAG de condensação.
+// Permite rejeitar em O(1) consultas entre nós que não se alcançam:
+// se u alcança v então wcc(u) == wcc(v) e, se scc(u) != scc(v),
+// level[scc(u)] < level[scc(v)]. arcAppend corrige o índice na hora: um
+// arco contra os níveis sobe os níveis a jusante e, se fechar um ciclo,
+// funde as componentes fortes do ciclo. Uma correção que passe do orçamento
+// deixa o índice stale (só o teste de componentes fracas vale) e arcAppend
+// o reconstrói depois de uma fração dos arcos. As consultas não escrevem nele.
+class componentIndex {
+public:
+    bool enabled = false;          // construído ao menos uma vez
+    bool stale = false;            // níveis inválidos até a próxima reconstrução
+    vector<int> wcc;               // floresta union-find (raiz = rótulo)
+    vector<int> wcc_size;          // nós de cada raiz (união por tamanho)
+    vector<int> scc;               // componente forte de cada nó (id original)
+    vector<int> scc_rep;           // floresta de fusões de ids (raiz = rótulo)
+    vector<int> scc_size;          // nós de cada raiz de scc_rep
+    vector<int> level;             // nível topológico de cada componente forte
+    vector< vector<int> > dag;     // arcos do DAG de condensação (ids podem estar fundidos)
+    int num_wcc = 0;
+    int num_scc = 0;
+    int threads = 0;               // threads usadas na (re)construção
+    long long arcs = 0;            // arcos do grafo
+    long long stale_arcs = 0;      // arcos adicionados desde que ficou stale
+
+    void build(const graph& G, int threads = 0);
+    void onNodeAppend();
+    void onArcAppend(int from, int to);
+    int findWcc(int u);            // com compressão; só para atualização
+    int wccLabel(int u) const;     // sem compressão; seguro entre threads
+    int findScc(int s);
+    int sccLabel(int s) const;
+    bool mayReach(int u, int v) const;
+    bool needsRebuild() const;     // stale há arcos suficientes para compensar
+
+private:
+    // Memória da correção incremental, reaproveitada entre arcos
+    vector<unsigned int> mark;     // mark[s] == generation: s na região visitada
+    vector<char> reach;            // s alcança a origem do arco novo
+    vector< pair<int, int> > call; // (componente, próximo arco) da DFS
+    vector<int> region;            // componentes visitadas em pós-ordem
+    vector<int> work;
+    unsigned int generation = 0;
+
+    bool raiseLevels(int s, size_t first, long long& budget);
+};
+
+// Área de trabalho reutilizável para caminhos mínimos a partir de uma fonte.
+// dist/prev são o resultado; os demais vetores são mantidos entre chamadas
+// para não realocar memória a cada consulta.
+class ssspWorkspace {
+public:
+    vector<int> dist;                   // numeric_limits<int>::max(): inalcançável
+    vector<int> prev;                   // -1: sem predecessor
+    vector< atomic<unsigned long long> > state;  // (dist << 32) | prev, em paralelo
+    vector<int> frontier;
+};
+
+// Área de trabalho da BFS paralela por níveis. dist (em arcos) e parent são
+// o resultado; o bitmap de visitados e as fronteiras são reaproveitados.
+class bfsWorkspace {
+public:
+    vector<int> dist;                   // numeric_limits<int>::max(): inalcançável
+    vector<int> parent;                 // -1: sem pai
+    vector< atomic<unsigned long long> > visited;  // um bit por nó
+    vector<int> frontier, next;
+    vector< vector<int> > local;        // próxima fronteira de cada thread
+    vector<size_t> offset;              // somas de prefixo dos tamanhos locais
+};
+
+// Arcos seguidos por graph::neighborhood
+enum neighborhoodFilter {
+    NB_ALL,             // todos os verbos
+    NB_HIERARCHICAL     // só os verbos hierárquicos
+};
+
+// Área de trabalho de graph::neighborhood. result é o resultado; as marcas
+// de visitado são por geração, então nada é zerado entre consultas.
+class neighborhoodWorkspace {
+public:
+    vector< pair<int, int> > result;    // (nó, distância) em ordem de BFS
+    bool truncated = false;             // parou no limite antes de esgotar a profundidade
+    vector<unsigned int> mark;
+    vector<int> local;                  // nó -> posição em result (onde mark == generation)
+    unsigned int generation = 0;
+};
+
+// Área de trabalho das buscas ponto a ponto (bfs, bfsHierarchical, dijkstra).
+// path é o resultado; dist/prev só valem onde mark == generation, então
+// nada é zerado nem realocado entre consultas.
+class searchWorkspace {
+public:
+    vector<int> path;                   // vazio: sem caminho
+    vector<int> dist;
+    vector<int> prev;
+    vector<unsigned int> mark;
+    vector<int> queue;                  // fila da BFS
+    vector< pair<int, int> > heap;      // (distância, nó) do Dijkstra
+    unsigned int generation = 0;
 };
 
 // Declarações das funções da fila (mantidas)
@@ -52,13 +210,27 @@ class graph {
 public: 
     vector<node> nd;
     vector< vector<arc> > a;
+    vector< vector<arcRef> > in;         // arcos de entrada de cada nó
+    unordered_map<string, int> index;    // substantivo -> índice em nd
     set<string> hierarchical_verbs; 
+    componentIndex comp;                 // opcional, ver buildComponentIndex
 
 
     int size() const; 
+    void clear();
     bool nodeIsIn(string S);
+    int nodeIndex(const string& S) const;
     void nodeAppend(string S);
-    void arcAppend(string S1, string V, string S2);
+    void arcAppend(string S1, string V, string S2, int peso = 1);
+
+    // Acesso aos vizinhos sem cópia
+    const string& noun(int idx) const;
+    arcSpan neighbors(int idx) const;
+    inArcSpan inNeighbors(int idx) const;
+
+    // Índice de componentes para rejeitar consultas impossíveis
+    void buildComponentIndex(int threads = 0);
+    bool mayReach(int start_node_idx, int end_node_idx) const;
 
     void printRelations(string S);
     void printSubs();
@@ -73,4 +245,55 @@ public:
     // NOVO: Declaração do Dijkstra
     vector<int> dijkstra(int start_node_idx, int end_node_idx);
     // --- Fim Funções para o Trabalho B ---
-};
\ No newline at end of file
+
+    // Mesmas buscas sem alocação por consulta e sem escrever no grafo:
+    // podem rodar em paralelo, uma área de trabalho por thread
+    const vector<int>& bfs(int start_node_idx, int end_node_idx, searchWorkspace& W) const;
+    const vector<int>& bfsHierarchical(int start_node_idx, int end_node_idx, searchWorkspace& W) const;
+    const vector<int>& dijkstra(int start_node_idx, int end_node_idx, searchWorkspace& W) const;
+
+    // Árvore completa de caminhos mínimos (delta-stepping em paralelo)
+    void sssp(int start_node_idx, ssspWorkspace& W, int threads = 0, int delta = 0) const;
+
+    // BFS completa de uma fonte, nível a nível em paralelo
+    void bfsParallel(int start_node_idx, bfsWorkspace& W, int threads = 0) const;
+
+    // Nós a no máximo k arcos de start (até limit nós; 0 = sem limite)
+    int neighborhood(int start_node_idx, int k, neighborhoodFilter filter, size_t limit,
+                     neighborhoodWorkspace& W) const;
+    // Subgrafo induzido pelo último resultado de neighborhood, independente deste
+    void neighborhoodGraph(const neighborhoodWorkspace& W, neighborhoodFilter filter, graph& out) const;
+};
+
+// Formatos de saída para escrita em lote de relações
+enum relationFormat {
+    REL_TSV,    // sujeito<TAB>verbo<TAB>objeto
+    REL_JSON    // JSON Lines: um objeto {"sujeito","verbo","objeto"} por linha
+};
+
+// Escritor bufferizado de relações: acumula a saída formatada em memória e
+// só escreve no stream quando o buffer enche (ou em flush()), sem um flush
+// por linha como em printRelations.
+class relationWriter {
+public:
+    relationWriter(ostream& out, relationFormat fmt, size_t capacity = 1 << 16);
+    ~relationWriter();
+
+    void write(const graph& G, const arc& e);
+    void writeRelations(const graph& G, int node_idx);
+    void writeIncoming(const graph& G, int node_idx);
+    void flush();
+
+private:
+    ostream& out;
+    relationFormat fmt;
+    size_t capacity;
+    string buf;
+
+    void appendField(const string& S);
+
+    relationWriter(const relationWriter&) = delete;
+    relationWriter& operator=(const relationWriter&) = delete;
+};
+
+#endif
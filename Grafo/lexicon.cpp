@@ -0,0 +1,308 @@
+#include "lexicon.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    UTF-8
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void utf8Decode(const string& S, vector<unsigned int>& out) {
+    out.clear();
+    const unsigned char* p = (const unsigned char*)S.data();
+    size_t n = S.size(), i = 0;
+    while (i < n) {
+        unsigned int c = p[i];
+        int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+        unsigned int cp = len == 1 ? c : len == 2 ? (c & 0x1F) : len == 3 ? (c & 0x0F) : (c & 0x07);
+        bool ok = len > 0 && i + len <= n;
+        for (int k = 1; ok && k < len; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) ok = false;
+            else cp = (cp << 6) | (p[i + k] & 0x3F);
+        }
+        // Rejeita formas longas demais, substitutos e valores acima de U+10FFFF
+        static const unsigned int minimo[5] = {0, 0, 0x80, 0x800, 0x10000};
+        if (ok && (cp < minimo[len] || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)) ok = false;
+        if (!ok) {
+            out.push_back(0x110000 + c);
+            i++;
+            continue;
+        }
+        out.push_back(cp);
+        i += len;
+    }
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Construção do autômato mínimo
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+namespace {
+
+struct builderState {
+    bool final = false;
+    vector< pair<unsigned int, unsigned int> > arcs;   // (rótulo, estado)
+};
+
+// Construção incremental de Daciuk et al. para entradas ordenadas: só o
+// caminho da última palavra pode mudar; ao divergir dele, os estados que
+// saem do caminho são trocados por um equivalente já registrado ou
+// registrados eles mesmos.
+struct dawgBuilder {
+    vector<builderState> B;
+    vector<unsigned int> livres;        // estados descartados, para reuso
+    unordered_map<string, unsigned int> registro;
+    vector<unsigned int> path;          // path[i]: estado após i símbolos
+    vector<unsigned int> anterior;
+    string sig;
+
+    dawgBuilder() {
+        this->B.push_back(builderState());
+        this->path.push_back(0);
+    }
+
+    unsigned int newState() {
+        if (!this->livres.empty()) {
+            unsigned int s = this->livres.back();
+            this->livres.pop_back();
+            this->B[s] = builderState();
+            return s;
+        }
+        this->B.push_back(builderState());
+        return this->B.size() - 1;
+    }
+
+    void signature(const builderState& st) {
+        this->sig.clear();
+        this->sig += (char)st.final;
+        for (const auto& a : st.arcs) {
+            this->sig.append((const char*)&a.first, sizeof(a.first));
+            this->sig.append((const char*)&a.second, sizeof(a.second));
+        }
+    }
+
+    void replaceOrRegister(size_t depth) {
+        while (this->path.size() > depth + 1) {
+            unsigned int child = this->path.back();
+            this->path.pop_back();
+            unsigned int parent = this->path.back();
+            this->signature(this->B[child]);
+            auto it = this->registro.find(this->sig);
+            if (it != this->registro.end()) {
+                this->B[parent].arcs.back().second = it->second;
+                this->livres.push_back(child);
+            } else {
+                this->registro.emplace(this->sig, child);
+            }
+        }
+    }
+
+    void add(const vector<unsigned int>& w) {
+        size_t cp = 0;
+        while (cp < w.size() && cp < this->anterior.size() && w[cp] == this->anterior[cp]) cp++;
+        this->replaceOrRegister(cp);
+        for (size_t i = cp; i < w.size(); ++i) {
+            unsigned int s = this->newState();
+            this->B[this->path.back()].arcs.push_back(make_pair(w[i], s));
+            this->path.push_back(s);
+        }
+        this->B[this->path.back()].final = true;
+        this->anterior = w;
+    }
+};
+
+}
+
+void nounLexicon::build(const graph& G) {
+    /*
+        Decodifica e ordena os substantivos por pontos de código, monta o
+        autômato mínimo e o congela em vetores contíguos numerando os
+        estados em largura a partir da raiz.
+    */
+    vector< pair< vector<unsigned int>, int > > palavras(G.size());
+    for (int i = 0; i < G.size(); ++i) {
+        utf8Decode(G.noun(i), palavras[i].first);
+        palavras[i].second = i;
+    }
+    sort(palavras.begin(), palavras.end());
+
+    dawgBuilder D;
+    this->ids.clear();
+    for (size_t k = 0; k < palavras.size(); ++k) {
+        if (k > 0 && palavras[k].first == palavras[k - 1].first) continue;
+        D.add(palavras[k].first);
+        this->ids.push_back(palavras[k].second);
+    }
+    D.replaceOrRegister(0);
+    vector< pair< vector<unsigned int>, int > >().swap(palavras);
+
+    // Numeração em largura dos estados alcançáveis
+    const unsigned int NONE = ~0u;
+    vector<unsigned int> novo(D.B.size(), NONE);
+    vector<unsigned int> ordem;
+    novo[0] = 0;
+    ordem.push_back(0);
+    for (size_t h = 0; h < ordem.size(); ++h)
+        for (const auto& a : D.B[ordem[h]].arcs)
+            if (novo[a.second] == NONE) {
+                novo[a.second] = ordem.size();
+                ordem.push_back(a.second);
+            }
+
+    size_t ns = ordem.size();
+    this->arc_begin.assign(ns + 1, 0);
+    this->final.assign(ns, 0);
+    this->count.assign(ns, 0);
+    this->label.clear();
+    this->target.clear();
+    for (size_t s = 0; s < ns; ++s) {
+        const builderState& st = D.B[ordem[s]];
+        this->final[s] = st.final;
+        this->arc_begin[s] = this->label.size();
+        for (const auto& a : st.arcs) {
+            this->label.push_back(a.first);
+            this->target.push_back(novo[a.second]);
+        }
+    }
+    this->arc_begin[ns] = this->label.size();
+
+    // Contagens em ordem topológica reversa: num DAG numerado em largura
+    // um arco pode apontar para trás, então usa uma pós-ordem explícita
+    vector<unsigned char> feito(ns, 0);
+    vector< pair<unsigned int, unsigned int> > pilha;   // (estado, próximo arco)
+    pilha.push_back(make_pair(0u, this->arc_begin[0]));
+    while (!pilha.empty()) {
+        unsigned int s = pilha.back().first;
+        unsigned int& k = pilha.back().second;
+        if (k < this->arc_begin[s + 1]) {
+            unsigned int t = this->target[k++];
+            if (!feito[t]) pilha.push_back(make_pair(t, this->arc_begin[t]));
+            continue;
+        }
+        unsigned int c = this->final[s];
+        for (unsigned int a = this->arc_begin[s]; a < this->arc_begin[s + 1]; ++a)
+            c += this->count[this->target[a]];
+        this->count[s] = c;
+        feito[s] = 1;
+        pilha.pop_back();
+    }
+
+    this->before.assign(this->label.size(), 0);
+    for (size_t s = 0; s < ns; ++s) {
+        unsigned int acc = this->final[s];
+        for (unsigned int a = this->arc_begin[s]; a < this->arc_begin[s + 1]; ++a) {
+            this->before[a] = acc;
+            acc += this->count[this->target[a]];
+        }
+    }
+}
+
+size_t nounLexicon::bytes() const {
+    return this->arc_begin.size() * sizeof(unsigned int) + this->final.size()
+         + this->count.size() * sizeof(unsigned int)
+         + this->label.size() * sizeof(unsigned int) * 3
+         + this->ids.size() * sizeof(int);
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Consultas
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+int nounLexicon::step(unsigned int s, unsigned int c) const {
+    const unsigned int* b = this->label.data() + this->arc_begin[s];
+    const unsigned int* e = this->label.data() + this->arc_begin[s + 1];
+    const unsigned int* it = lower_bound(b, e, c);
+    if (it == e || *it != c) return -1;
+    return it - this->label.data();
+}
+
+int nounLexicon::lookup(const string& S) const {
+    if (this->ids.empty()) return -1;
+    vector<unsigned int> q;
+    utf8Decode(S, q);
+    unsigned int s = 0, rank = 0;
+    for (unsigned int c : q) {
+        int a = this->step(s, c);
+        if (a < 0) return -1;
+        rank += this->before[a];
+        s = this->target[a];
+    }
+    return this->final[s] ? this->ids[rank] : -1;
+}
+
+vector<int> nounLexicon::prefix(const string& P, size_t limit) const {
+    /*
+        As palavras abaixo de um estado têm ranks contíguos, então a
+        enumeração é uma fatia da tabela de IDs, sem percorrer o autômato.
+    */
+    vector<int> out;
+    if (this->ids.empty()) return out;
+    vector<unsigned int> q;
+    utf8Decode(P, q);
+    unsigned int s = 0, rank = 0;
+    for (unsigned int c : q) {
+        int a = this->step(s, c);
+        if (a < 0) return out;
+        rank += this->before[a];
+        s = this->target[a];
+    }
+    size_t n = this->count[s];
+    if (limit > 0 && limit < n) n = limit;
+    out.assign(this->ids.begin() + rank, this->ids.begin() + rank + n);
+    return out;
+}
+
+void nounLexicon::fuzzyWalk(unsigned int s, unsigned int rank, const vector<unsigned int>& q,
+                            vector< vector<int> >& rows, size_t depth,
+                            int max_dist, vector< pair<int, int> >& out) const {
+    /*
+        Busca em profundidade com uma linha da matriz de Levenshtein por
+        nível; o ramo é podado quando nenhuma célula da linha fica dentro
+        do limite.
+    */
+    const size_t m = q.size();
+    const vector<int>& row = rows[depth];
+    if (this->final[s] && row[m] <= max_dist)
+        out.push_back(make_pair(this->ids[rank], row[m]));
+    if (rows.size() <= depth + 1) rows.push_back(vector<int>(m + 1));
+    for (unsigned int a = this->arc_begin[s]; a < this->arc_begin[s + 1]; ++a) {
+        unsigned int c = this->label[a];
+        vector<int>& nr = rows[depth + 1];
+        const vector<int>& pr = rows[depth];
+        nr[0] = pr[0] + 1;
+        int menor = nr[0];
+        for (size_t j = 1; j <= m; ++j) {
+            int v = min(pr[j] + 1, nr[j - 1] + 1);
+            v = min(v, pr[j - 1] + (q[j - 1] != c));
+            nr[j] = v;
+            menor = min(menor, v);
+        }
+        if (menor <= max_dist)
+            this->fuzzyWalk(this->target[a], rank + this->before[a], q, rows, depth + 1, max_dist, out);
+    }
+}
+
+vector< pair<int, int> > nounLexicon::fuzzy(const string& S, int max_dist, size_t limit) const {
+    vector< pair<int, int> > out;
+    if (this->ids.empty() || max_dist < 0) return out;
+    vector<unsigned int> q;
+    utf8Decode(S, q);
+    vector< vector<int> > rows(1, vector<int>(q.size() + 1));
+    for (size_t j = 0; j <= q.size(); ++j) rows[0][j] = j;
+    this->fuzzyWalk(0, 0, q, rows, 0, max_dist, out);
+    // A busca produz em ordem lexicográfica; ordena estável pela distância
+    stable_sort(out.begin(), out.end(), [](const pair<int, int>& x, const pair<int, int>& y) {
+        return x.second < y.second;
+    });
+    if (limit > 0 && out.size() > limit) out.resize(limit);
+    return out;
+}
@@ -0,0 +1,54 @@
+#ifndef LEXICON_H
+#define LEXICON_H
+
+#include "graph.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Léxico somente leitura dos substantivos do grafo: um autômato acíclico
+// mínimo (DAWG) sobre pontos de código Unicode, guardado em vetores
+// contíguos. Prefixos e sufixos comuns são compartilhados. Cada estado
+// sabe quantas palavras aceita, o que dá a posição (rank) de cada palavra
+// na ordem lexicográfica; o rank indexa a tabela de IDs de nós (hash
+// perfeito mínimo). As distâncias de edição contam pontos de código, não
+// bytes: "avião" está a 1 de "aviao".
+// É uma fotografia: depois de nodeAppend é preciso chamar build de novo.
+class nounLexicon {
+public:
+    void build(const graph& G);
+
+    int lookup(const string& S) const;                      // ID do nó ou -1
+    // IDs dos substantivos com o prefixo dado, em ordem lexicográfica
+    vector<int> prefix(const string& P, size_t limit = 0) const;
+    // (ID, distância) dos substantivos a no máximo max_dist edições de S,
+    // ordenados pela distância e depois lexicograficamente
+    vector< pair<int, int> > fuzzy(const string& S, int max_dist, size_t limit = 0) const;
+
+    size_t words() const { return this->ids.size(); }
+    size_t states() const { return this->arc_begin.empty() ? 0 : this->arc_begin.size() - 1; }
+    size_t arcs() const { return this->label.size(); }
+    size_t bytes() const;
+
+private:
+    // Estado s: arcos em [arc_begin[s], arc_begin[s+1]), rótulos crescentes
+    vector<unsigned int> arc_begin;
+    vector<unsigned char> final;
+    vector<unsigned int> count;         // palavras aceitas a partir do estado
+    vector<unsigned int> label;         // ponto de código do arco
+    vector<unsigned int> target;
+    vector<unsigned int> before;        // palavras que vêm antes ao seguir este arco
+    vector<int> ids;                    // rank -> ID do nó
+
+    int step(unsigned int s, unsigned int c) const;          // arco ou -1
+    void fuzzyWalk(unsigned int s, unsigned int rank, const vector<unsigned int>& q,
+                   vector< vector<int> >& rows, size_t depth,
+                   int max_dist, vector< pair<int, int> >& out) const;
+};
+
+// Decodifica UTF-8 em pontos de código. Um byte inválido b vira o símbolo
+// 0x110000 + b (fora do Unicode), para que a decodificação seja injetiva.
+void utf8Decode(const string& S, vector<unsigned int>& out);
+
+#endif
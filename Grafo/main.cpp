@@ -1,4 +1,7 @@
 #include "graph.h"
+#include "ch.h"
+#include "perf.h"
+#include "baseline.h"
 #include <iostream>
 #include <vector> 
 #include <string> 
@@ -7,26 +10,23 @@
 #include <limits> 
 #include <cmath>  
 #include <iomanip> 
+#include <cstring>
+#include <cstdlib>
+#include <functional>
 
 using namespace std;
 
 // Função auxiliar para encontrar o índice de um nó dado seu substantivo
 int getNodeIndex(const graph& g, const string& s) { 
-    for (size_t i = 0; i < g.size(); ++i) { 
-        if (g.nd[i] == s) { 
-            return i;
-        }
-    }
-    return -1; 
+    return g.nodeIndex(s);
 }
 
 // Função auxiliar para gerar um grafo com um número específico de arestas
 // Alterada para usar os substantivos já carregados para evitar duplicação.
-void generateRandomGraph(graph& g, int num_edges, const vector<string>& all_substantives, const set<string>& hierarchical_verbs_list) {
-    // Limpa o grafo existente
-    g.nd.clear();
-    g.a.clear();
-    g.hierarchical_verbs.clear(); // Limpa e adiciona novamente para cada geração
+// A semente fixa o grafo gerado, para que execuções diferentes sejam comparáveis.
+void generateRandomGraph(graph& g, int num_edges, const vector<string>& all_substantives, const set<string>& hierarchical_verbs_list, unsigned int seed) {
+    // Limpa o grafo existente (nós, arcos, índices e verbos hierárquicos)
+    g.clear(); // Verbos hierárquicos são adicionados novamente para cada geração
 
     // Adiciona os verbos hierárquicos passados como parâmetro
     for (const string& verb : hierarchical_verbs_list) {
@@ -39,8 +39,7 @@ void generateRandomGraph(graph& g, int num_edges, const vector<string>& all_subs
     }
 
     // Gerador de números aleatórios para escolher nós e verbos
-    random_device rd;
-    mt19937 gen(rd());
+    mt19937 gen(seed);
     // Garante que a distribuição não tente acessar um índice fora dos limites se o grafo tiver 0 nós.
     uniform_int_distribution<> distrib_node(0, g.size() > 0 ? g.size() - 1 : 0); 
     
@@ -81,7 +80,47 @@ void generateRandomGraph(graph& g, int num_edges, const vector<string>& all_subs
 }
 
 
-int main(){
+// Roda o lote inteiro de consultas entre um único par de leituras de relógio
+// e de contadores, sem o custo de medir cada consulta. Imprime os números por
+// consulta e por arco do grafo (as buscas percorrem no máximo todos os arcos).
+template <class F>
+void reportBatch(const string& nome, const vector< pair<int, int> >& pares, long long num_arcs,
+                 perfCounters& P, F consulta) {
+    for (const auto& q : pares) consulta(q.first, q.second);   // aquecimento
+
+    P.reset();
+    auto start = chrono::high_resolution_clock::now();
+    P.start();
+    for (const auto& q : pares) consulta(q.first, q.second);
+    P.stop();
+    auto end = chrono::high_resolution_clock::now();
+
+    double n = pares.size();
+    double ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / n;
+    cout << "    " << nome << ": " << fixed << setprecision(2) << ns << " ns/consulta" << endl;
+    if (!P.available()) return;
+
+    const char* rotulo[PERF_NUM_EVENTS] = {"ciclos", "instrucoes", "L1D misses", "LLC misses", "branch misses"};
+    cout << "      por consulta:";
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+        if (P.has((perfEvent)e)) cout << " " << rotulo[e] << "=" << setprecision(1) << P.value[e] / n;
+    cout << endl;
+    if (num_arcs > 0 && P.has(PERF_CYCLES)) {
+        cout << "      por arco: ciclos=" << setprecision(3) << P.value[PERF_CYCLES] / n / num_arcs;
+        if (P.has(PERF_LLC_MISSES)) cout << " LLC misses=" << P.value[PERF_LLC_MISSES] / n / num_arcs;
+        cout << endl;
+    }
+    // IPC baixo com muitos misses por mil instruções indica espera por memória
+    if (P.has(PERF_CYCLES) && P.has(PERF_INSTRUCTIONS) && P.value[PERF_CYCLES] > 0) {
+        double instr = P.value[PERF_INSTRUCTIONS];
+        cout << "      IPC=" << setprecision(2) << instr / P.value[PERF_CYCLES];
+        if (P.has(PERF_L1D_MISSES) && instr > 0) cout << " L1D MPKI=" << 1000.0 * P.value[PERF_L1D_MISSES] / instr;
+        if (P.has(PERF_LLC_MISSES) && instr > 0) cout << " LLC MPKI=" << 1000.0 * P.value[PERF_LLC_MISSES] / instr;
+        cout << endl;
+    }
+}
+
+int main(int argc, char** argv){
     // Setup para medição de tempo
     using std::chrono::high_resolution_clock;
     using std::chrono::duration_cast;
@@ -91,6 +130,51 @@ int main(){
     vector<int> num_edges_to_test = {10, 20, 30, 40, 50}; // Grafos com 10, 20, 30, 40 e 50 arestas
     const int num_queries_per_config = 1000;             // VOLTANDO PARA 1000 CONSULTAS
 
+    // --perf: mede também cada algoritmo em lote com contadores de hardware
+    // --baseline-save/--baseline-compare ARQ: rodadas repetidas guardadas ou
+    //   comparadas com uma execução anterior (--runs, --trials, --threshold,
+    //   --pin, --seed). Cada um dos --runs processos mede --trials rodadas e
+    //   contribui com a mediana delas: a variação entre processos (leiaute
+    //   de memória, estado do alocador) é bem maior que a de dentro de um
+    //   processo, então a amostra do teste é o processo, não a rodada.
+    // --baseline-worker ARQ: uso interno, um desses processos
+    bool use_perf = false;
+    string baseline_save, baseline_compare, baseline_worker;
+    int runs = 10;
+    int trials = 10;
+    double threshold_pct = 25.0;
+    int pin_cpu = -1;
+    long long seed = -1;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool tem_valor = i + 1 < argc;
+        if (arg == "--perf") use_perf = true;
+        else if (arg == "--baseline-save" && tem_valor) baseline_save = argv[++i];
+        else if (arg == "--baseline-compare" && tem_valor) baseline_compare = argv[++i];
+        else if (arg == "--baseline-worker" && tem_valor) baseline_worker = argv[++i];
+        else if (arg == "--runs" && tem_valor) runs = max(1, atoi(argv[++i]));
+        else if (arg == "--trials" && tem_valor) trials = max(1, atoi(argv[++i]));
+        else if (arg == "--threshold" && tem_valor) threshold_pct = atof(argv[++i]);
+        else if (arg == "--pin" && tem_valor) pin_cpu = atoi(argv[++i]);
+        else if (arg == "--seed" && tem_valor) seed = atoll(argv[++i]);
+        else {
+            cerr << "Uso: " << argv[0] << " [--perf] [--baseline-save ARQ] [--baseline-compare ARQ]"
+                 << " [--runs N] [--trials N] [--threshold PCT] [--pin CPU] [--seed S]" << endl;
+            return 1;
+        }
+    }
+    bool use_baseline = !baseline_save.empty() || !baseline_compare.empty() || !baseline_worker.empty();
+    // Com baseline, grafos e consultas precisam ser os mesmos em toda execução
+    if (use_baseline && seed < 0) seed = 42;
+    if (pin_cpu >= 0 && !pinToCpu(pin_cpu))
+        cerr << "Erro: Nao foi possivel prender o processo na CPU " << pin_cpu << "; seguindo sem afinidade." << endl;
+    const string maquina = machineFingerprint();
+    const string gerador = "aleatorio_data.txt_seed" + to_string(seed);
+    baselineStore resultados;
+    perfCounters perf;
+    if (use_perf && !perf.available())
+        cout << "Contadores de hardware indisponiveis (" << perf.error() << "): apenas tempo por lote." << endl;
+
     // Definir os verbos hierárquicos. Estes serão passados para a função generateRandomGraph
     // e também definidos no grafo principal para as buscas.
     set<string> hierarchical_verbs_list;
@@ -115,7 +199,7 @@ int main(){
     
     // Configurar gerador de números aleatórios para queries UMA ÚNICA VEZ
     random_device rd_queries;
-    mt19937 gen_queries(rd_queries()); 
+    mt19937 gen_queries(seed >= 0 ? (unsigned int)seed : rd_queries()); 
     
     cout << "Iniciando Avaliacao de Performance do Trabalho B." << endl;
     cout << "------------------------------------------------" << endl;
@@ -125,7 +209,8 @@ int main(){
         cout << "\n--- Testando Grafo com " << num_edges << " Arestas ---" << endl;
 
         graph G;
-        generateRandomGraph(G, num_edges, all_substantives, hierarchical_verbs_list);
+        generateRandomGraph(G, num_edges, all_substantives, hierarchical_verbs_list,
+                            seed >= 0 ? (unsigned int)(seed + num_edges) : rd_queries());
 
         // Comentar linhas de DEBUG se a saída estiver muito grande
         // cout << "  DEBUG: Grafo gerado com " << G.size() << " nos." << endl;
@@ -215,10 +300,12 @@ int main(){
         cout << "\n  --- Performance Dijkstra ---" << endl;
         long long total_dijkstra_duration_ns = 0;
         vector<long long> dijkstra_durations_ns;
+        vector< pair<int, int> > dijkstra_pares;     // repetidos na CH
 
         for (int i = 0; i < num_queries_per_config; ++i) {
             int start_idx = distrib_query_node(gen_queries);
             int end_idx = distrib_query_node(gen_queries);
+            dijkstra_pares.push_back(make_pair(start_idx, end_idx));
 
             auto start = high_resolution_clock::now();
             G.dijkstra(start_idx, end_idx); 
@@ -240,9 +327,184 @@ int main(){
         }
         cout << "    Tempo Medio (Dijkstra): " << fixed << setprecision(2) << avg_dijkstra_ns << " ns" << endl;
         cout << "    Desvio Padrao (Dijkstra): " << fixed << setprecision(2) << std_dev_dijkstra_ns << " ns" << endl;
+
+        // --- Hierarquia de Contração ---
+        // Pré-processamento uma vez por grafo; as consultas substituem o Dijkstra
+        cout << "\n  --- Performance Hierarquia de Contracao ---" << endl;
+        contractionHierarchy CH;
+        CH.build(G);
+        cout << "    Pre-processamento: " << fixed << setprecision(2) << CH.build_seconds * 1e6 << " us, "
+             << CH.num_shortcuts << " atalhos" << endl;
+
+        // Mesmos pares do Dijkstra, para que a aceleração compare as mesmas consultas
+        long long total_ch_duration_ns = 0;
+        for (const auto& q : dijkstra_pares) {
+            auto start = high_resolution_clock::now();
+            CH.query(q.first, q.second);
+            auto end = high_resolution_clock::now();
+
+            total_ch_duration_ns += duration_cast<nanoseconds>(end - start).count();
+        }
+        double avg_ch_ns = (double)total_ch_duration_ns / num_queries_per_config;
+        cout << "    Tempo Medio (CH): " << fixed << setprecision(2) << avg_ch_ns << " ns" << endl;
+        if (avg_ch_ns > 0)
+            cout << "    Aceleracao sobre Dijkstra: " << fixed << setprecision(2) << avg_dijkstra_ns / avg_ch_ns << "x" << endl;
+
+        // --- Lotes com contadores de hardware ---
+        if (use_perf) {
+            cout << "\n  --- Lotes com Contadores de Hardware ---" << endl;
+            vector< pair<int, int> > pares(num_queries_per_config);
+            for (auto& q : pares) {
+                q.first = distrib_query_node(gen_queries);
+                q.second = distrib_query_node(gen_queries);
+            }
+            long long num_arcs = 0;
+            for (int u = 0; u < G.size(); ++u) num_arcs += G.a[u].size();
+            reportBatch("BFS", pares, num_arcs, perf, [&](int s, int e) { G.bfs(s, e); });
+            reportBatch("BFS Hierarquica", pares, num_arcs, perf, [&](int s, int e) { G.bfsHierarchical(s, e); });
+            reportBatch("Dijkstra", pares, num_arcs, perf, [&](int s, int e) { G.dijkstra(s, e); });
+            reportBatch("CH", pares, num_arcs, perf, [&](int s, int e) { CH.query(s, e); });
+        }
+
+        // --- Rodadas repetidas para baseline ---
+        // Cada rodada mede o lote inteiro de cada algoritmo (uma amostra de
+        // ns/consulta por rodada), alternando os algoritmos entre rodadas
+        // para que variações lentas da máquina afetem todos igualmente.
+        if (!baseline_worker.empty()) {
+            cout << "\n  --- Rodadas para Baseline (" << trials << ") ---" << endl;
+            // Gerador próprio: os pares não dependem de --perf nem de quantas
+            // consultas as seções anteriores sortearam
+            mt19937 gen_baseline((unsigned int)(seed + num_edges) ^ 0x9e3779b9u);
+            vector< pair<int, int> > pares(num_queries_per_config);
+            for (auto& q : pares) {
+                q.first = distrib_query_node(gen_baseline);
+                q.second = distrib_query_node(gen_baseline);
+            }
+            vector< pair< string, function<void(int, int)> > > algoritmos = {
+                {"BFS", [&](int s, int e) { G.bfs(s, e); }},
+                {"BFS_Hierarquica", [&](int s, int e) { G.bfsHierarchical(s, e); }},
+                {"Dijkstra", [&](int s, int e) { G.dijkstra(s, e); }},
+                {"CH", [&](int s, int e) { CH.query(s, e); }},
+            };
+            for (auto& alg : algoritmos)                          // aquecimento
+                for (const auto& q : pares) alg.second(q.first, q.second);
+            for (int t = 0; t < trials; ++t) {
+                for (auto& alg : algoritmos) {
+                    auto start = high_resolution_clock::now();
+                    for (const auto& q : pares) alg.second(q.first, q.second);
+                    auto end = high_resolution_clock::now();
+                    double ns = duration_cast<nanoseconds>(end - start).count() / (double)pares.size();
+                    resultados.samples[baselineStore::key(alg.first, gerador, num_edges, maquina)].push_back(ns);
+                }
+            }
+            for (auto& alg : algoritmos)
+                cout << "    Mediana (" << alg.first << "): " << fixed << setprecision(2)
+                     << median(resultados.samples[baselineStore::key(alg.first, gerador, num_edges, maquina)])
+                     << " ns" << endl;
+        }
     }
     cout << "\n------------------------------------------------" << endl;
     cout << "Avaliacao de Performance Concluida." << endl;
 
-    return 0;
+    if (!baseline_worker.empty()) {
+        if (!resultados.save(baseline_worker)) {
+            cerr << "Erro: Nao foi possivel gravar as rodadas em " << baseline_worker << "." << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (use_baseline) {
+        // Cada processo grava suas rodadas num arquivo temporário; aqui fica
+        // só a mediana de cada um
+        cout << "\nRodadas para baseline: " << runs << " processo(s) x " << trials << " rodada(s)" << endl;
+        for (int r = 0; r < runs; ++r) {
+            string temp = tempFile();
+            if (temp.empty()) {
+                cerr << "Erro: Nao foi possivel criar arquivo temporario para as rodadas." << endl;
+                return 1;
+            }
+            vector<string> args = {"--baseline-worker", temp, "--trials", to_string(trials),
+                                   "--seed", to_string(seed)};
+            if (pin_cpu >= 0) {
+                args.push_back("--pin");
+                args.push_back(to_string(pin_cpu));
+            }
+            baselineStore rodadas;
+            bool ok = runSelf(args) && rodadas.load(temp);
+            remove(temp.c_str());
+            if (!ok) {
+                cerr << "Erro: Processo de medicao " << r + 1 << " de " << runs << " falhou." << endl;
+                return 1;
+            }
+            for (const auto& kv : rodadas.samples)
+                resultados.samples[kv.first].push_back(median(kv.second));
+        }
+        for (const auto& kv : resultados.samples)
+            cout << "  Mediana (" << kv.first.substr(0, kv.first.rfind('|')) << "): "
+                 << fixed << setprecision(2) << median(kv.second) << " ns" << endl;
+    }
+
+    int status = 0;
+    if (!baseline_compare.empty()) {
+        /*
+            Regressão: processo mais rápido mais lento que o mais rápido da
+            baseline além do limiar e Mann-Whitney unilateral significativo.
+            O ruído só acrescenta tempo e a fração de processos "lentos"
+            muda com o estado da máquina, então o mínimo das medianas é
+            mais estável que a mediana delas. As duas condições juntas
+            evitam falhar por ruído ou por diferenças irrelevantes.
+            O nível 0.05 é dividido pelo número de chaves comparadas
+            (Bonferroni): com ~20 chaves, p < 0.05 em cada uma falharia
+            com frequência em alguma por acaso.
+        */
+        baselineStore base;
+        if (!base.load(baseline_compare)) {
+            cerr << "Erro: Nao foi possivel ler a baseline " << baseline_compare << "." << endl;
+            return 1;
+        }
+        cout << "\nComparacao com a baseline " << baseline_compare << " (limiar " << fixed << setprecision(1) << threshold_pct << "%):" << endl;
+        int regressoes = 0, comparadas = 0;
+        for (const auto& kv : resultados.samples) {
+            auto it = base.samples.find(kv.first);
+            if (it != base.samples.end() && !it->second.empty()) comparadas++;
+        }
+        double alfa = 0.05 / max(1, comparadas);
+        for (const auto& kv : resultados.samples) {
+            auto it = base.samples.find(kv.first);
+            cout << "  " << kv.first << ": ";
+            if (it == base.samples.end() || it->second.empty()) {
+                cout << "sem baseline para esta chave" << endl;
+                continue;
+            }
+            double mb = *min_element(it->second.begin(), it->second.end());
+            double mn = *min_element(kv.second.begin(), kv.second.end());
+            double variacao = mb > 0 ? (mn / mb - 1.0) * 100.0 : 0.0;
+            double p = mannWhitneyGreater(it->second, kv.second);
+            bool regressao = variacao > threshold_pct && p < alfa;
+            if (regressao) regressoes++;
+            cout << fixed << setprecision(2) << mb << " -> " << mn << " ns (" << showpos << variacao
+                 << noshowpos << "%, p=" << setprecision(4) << p << ")" << (regressao ? "  REGRESSAO" : "") << endl;
+        }
+        if (regressoes > 0) {
+            cout << "FALHA: " << regressoes << " medicao(oes) mais lenta(s) que a baseline alem de "
+                 << setprecision(1) << threshold_pct << "%." << endl;
+            status = 2;
+        } else {
+            cout << "OK: nenhuma regressao significativa." << endl;
+        }
+    }
+    if (!baseline_save.empty()) {
+        // Mantém as chaves de outras máquinas/configurações já guardadas no arquivo
+        baselineStore salvo;
+        salvo.load(baseline_save);
+        for (const auto& kv : resultados.samples) salvo.samples[kv.first] = kv.second;
+        if (!salvo.save(baseline_save)) {
+            cerr << "Erro: Nao foi possivel gravar a baseline " << baseline_save << "." << endl;
+            return 1;
+        }
+        cout << "Baseline gravada em " << baseline_save << " (" << resultados.samples.size() << " chaves)." << endl;
+    }
+
+    return status;
 }
\ No newline at end of file
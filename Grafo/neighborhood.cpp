@@ -0,0 +1,91 @@
+#include "graph.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Vizinhança de k arcos
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+int graph::neighborhood(int start_node_idx, int k, neighborhoodFilter filter, size_t limit,
+                        neighborhoodWorkspace& W) const {
+    /*
+        BFS a partir de start_node_idx que não expande os nós da
+        profundidade k. A ordem de BFS garante que, ao atingir o limite
+        (nós de hub), ficam os mais próximos. Retorna o número de nós no
+        resultado (incluindo o inicial).
+    */
+    W.result.clear();
+    W.truncated = false;
+    const int n = this->size();
+    if (start_node_idx < 0 || start_node_idx >= n) {
+        cerr << "Erro: Indice de no inicial invalido na vizinhanca." << endl;
+        return 0;
+    }
+    if ((int)W.mark.size() != n) {
+        W.mark.assign(n, 0);
+        W.local.resize(n);
+        W.generation = 0;
+    }
+    if (++W.generation == 0) {
+        fill(W.mark.begin(), W.mark.end(), 0);
+        W.generation = 1;
+    }
+
+    W.mark[start_node_idx] = W.generation;
+    W.local[start_node_idx] = 0;
+    W.result.push_back(make_pair(start_node_idx, 0));
+    for (size_t h = 0; h < W.result.size(); ++h) {
+        int u = W.result[h].first, d = W.result[h].second;
+        if (d >= k) break;              // os demais da fila também estão em k
+        for (const arc& e : this->a[u]) {
+            if (W.mark[e.to] == W.generation) continue;
+            if (filter == NB_HIERARCHICAL && !this->hierarchical_verbs.count(e.verbo)) continue;
+            // Há mais um nó dentro da profundidade, mas o limite já foi atingido
+            if (limit > 0 && W.result.size() >= limit) {
+                W.truncated = true;
+                return W.result.size();
+            }
+            W.mark[e.to] = W.generation;
+            W.local[e.to] = W.result.size();
+            W.result.push_back(make_pair(e.to, d + 1));
+        }
+    }
+    return W.result.size();
+}
+
+void graph::neighborhoodGraph(const neighborhoodWorkspace& W, neighborhoodFilter filter, graph& out) const {
+    /*
+        Copia os nós do resultado (na ordem de BFS: o inicial é o nó 0) e os
+        arcos entre eles que passam pelo filtro. O grafo gerado não depende
+        deste e pode ser servido, guardado ou gravado com relationWriter.
+    */
+    out.clear();
+    out.hierarchical_verbs = this->hierarchical_verbs;
+    const size_t m = W.result.size();
+    out.nd.reserve(m);
+    out.a.assign(m, vector<arc>());
+    out.in.assign(m, vector<arcRef>());
+    for (size_t i = 0; i < m; ++i) {
+        node nn;
+        nn.substantivo = this->noun(W.result[i].first);
+        out.index[nn.substantivo] = i;
+        out.nd.push_back(nn);
+    }
+    for (size_t i = 0; i < m; ++i) {
+        int u = W.result[i].first;
+        for (const arc& e : this->a[u]) {
+            if (W.mark[e.to] != W.generation) continue;
+            if (filter == NB_HIERARCHICAL && !this->hierarchical_verbs.count(e.verbo)) continue;
+            arc c = e;
+            c.from = i;
+            c.to = W.local[e.to];
+            out.in[c.to].push_back(arcRef{c.from, (int)out.a[i].size()});
+            out.a[i].push_back(c);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+    Utilitários simples de paralelismo sobre std::thread.
+------------------------------------------------------------------------------*/
+
+// Número de threads a usar: o valor pedido ou, se <= 0, o número de núcleos.
+inline int defaultThreads(int threads) {
+    if (threads > 0) return threads;
+    unsigned h = thread::hardware_concurrency();
+    return h > 0 ? (int)h : 1;
+}
+
+// Executa fn(tid) em 'threads' threads e espera todas terminarem.
+// Com uma thread só, executa na thread chamadora.
+template <class F>
+void parallelRun(int threads, F fn) {
+    if (threads <= 1) { fn(0); return; }
+    vector<thread> pool;
+    pool.reserve(threads - 1);
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(fn, t);
+    fn(0);
+    for (thread& th : pool) th.join();
+}
+
+// Divide [0, n) em blocos contíguos e chama fn(begin, end, tid) para cada um.
+// Intervalos pequenos rodam sequencialmente para não pagar o custo das threads.
+template <class F>
+void parallelFor(int threads, int n, F fn, int min_per_thread = 4096) {
+    if (n <= 0) return;
+    int t = min(threads, max(1, n / max(1, min_per_thread)));
+    if (t <= 1) { fn(0, n, 0); return; }
+    parallelRun(t, [&](int tid) {
+        long long b = (long long)n * tid / t;
+        long long e = (long long)n * (tid + 1) / t;
+        fn((int)b, (int)e, tid);
+    });
+}
+
+// Barreira reutilizável para 'n' threads (espera ativa com yield).
+// Útil para algoritmos em fases que mantêm as mesmas threads do início ao fim.
+class spinBarrier {
+public:
+    explicit spinBarrier(int n) : n(n), count(0), generation(0) {}
+
+    void wait() {
+        int gen = generation.load(memory_order_acquire);
+        if (count.fetch_add(1, memory_order_acq_rel) == n - 1) {
+            count.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+        } else {
+            while (generation.load(memory_order_acquire) == gen)
+                this_thread::yield();
+        }
+    }
+
+private:
+    int n;
+    atomic<int> count;
+    atomic<int> generation;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "graph.h"
+#include "parallel.h"
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    BFS paralela síncrona por níveis
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+void graph::bfsParallel(int start_node_idx, bfsWorkspace& W, int threads) const {
+    /*
+        Preenche W.dist (número de arcos) e W.parent com a árvore da BFS a
+        partir de start_node_idx. As distâncias são as mesmas de graph::bfs;
+        o pai escolhido entre os do nível anterior depende das threads.
+
+        A fronteira de cada nível é dividida em blocos distribuídos
+        dinamicamente. Um nó é reivindicado por quem ligar primeiro o seu
+        bit no bitmap de visitados (fetch_or atômico); só essa thread
+        escreve parent/dist dele, então esses vetores não precisam ser
+        atômicos. Cada thread acumula a próxima fronteira no seu buffer e os
+        buffers são concatenados na posição dada pela soma de prefixo dos
+        tamanhos.
+    */
+    const int n = this->size();
+    W.dist.assign(n, numeric_limits<int>::max());
+    W.parent.assign(n, -1);
+    if (start_node_idx < 0 || start_node_idx >= n) {
+        cerr << "Erro: Indice de no inicial invalido na BFS paralela." << endl;
+        return;
+    }
+
+    const int words = (n + 63) / 64;
+    if ((int)W.visited.size() != words)
+        vector< atomic<unsigned long long> >(words).swap(W.visited);
+    threads = defaultThreads(threads);
+    parallelFor(threads, words, [&](int b, int e, int) {
+        for (int i = b; i < e; ++i) W.visited[i].store(0, memory_order_relaxed);
+    });
+    W.visited[start_node_idx >> 6].store(1ULL << (start_node_idx & 63), memory_order_relaxed);
+    W.dist[start_node_idx] = 0;
+
+    W.frontier.assign(1, start_node_idx);
+    W.local.resize(threads);
+    W.offset.assign(threads + 1, 0);
+
+    atomic<size_t> cursor(0);
+    spinBarrier barrier(threads);
+    const size_t CHUNK = 64;
+    int level = 0;
+
+    parallelRun(threads, [&](int tid) {
+        vector<int>& mine = W.local[tid];
+        while (!W.frontier.empty()) {
+            const size_t tail = W.frontier.size();
+            const int nivel = level + 1;
+            mine.clear();
+            for (;;) {
+                size_t b = cursor.fetch_add(CHUNK, memory_order_relaxed);
+                if (b >= tail) break;
+                size_t e = min(tail, b + CHUNK);
+                for (size_t k = b; k < e; ++k) {
+                    int u = W.frontier[k];
+                    for (const arc& ed : this->a[u]) {
+                        int v = ed.to;
+                        atomic<unsigned long long>& word = W.visited[v >> 6];
+                        unsigned long long bit = 1ULL << (v & 63);
+                        // Leitura simples antes do fetch_or evita escrita em nós já vistos
+                        if (word.load(memory_order_relaxed) & bit) continue;
+                        if (word.fetch_or(bit, memory_order_relaxed) & bit) continue;
+                        W.parent[v] = u;
+                        W.dist[v] = nivel;
+                        mine.push_back(v);
+                    }
+                }
+            }
+            barrier.wait();
+            if (tid == 0) {
+                for (int t = 0; t < threads; ++t)
+                    W.offset[t + 1] = W.offset[t] + W.local[t].size();
+                W.next.resize(W.offset[threads]);
+            }
+            barrier.wait();
+            copy(mine.begin(), mine.end(), W.next.begin() + W.offset[tid]);
+            barrier.wait();
+            if (tid == 0) {
+                W.frontier.swap(W.next);
+                cursor.store(0, memory_order_relaxed);
+                level++;
+            }
+            barrier.wait();
+        }
+    });
+}
@@ -0,0 +1,125 @@
+#include "perf.h"
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Contadores de hardware
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+#if defined(__linux__)
+
+static int openEvent(uint32_t type, uint64_t config, int group) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0;          // só o líder começa desligado
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+                     | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+perfCounters::perfCounters() : leader(-1) {
+    /*
+        O primeiro evento que abrir vira o líder do grupo; os demais entram
+        no grupo para serem lidos juntos e agendados juntos.
+    */
+    static const uint32_t tipo[PERF_NUM_EVENTS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t config[PERF_NUM_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    this->reset();
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e) {
+        this->fd[e] = openEvent(tipo[e], config[e], this->leader);
+        if (this->fd[e] < 0) {
+            if (this->err.empty()) this->err = strerror(errno);
+            continue;
+        }
+        if (this->leader < 0) this->leader = this->fd[e];
+    }
+    if (this->leader >= 0) this->err.clear();
+}
+
+perfCounters::~perfCounters() {
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e)
+        if (this->fd[e] >= 0) close(this->fd[e]);
+}
+
+void perfCounters::start() {
+    if (this->leader < 0) return;
+    ioctl(this->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(this->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perfCounters::stop() {
+    /*
+        Leitura em grupo: nr, tempo habilitado, tempo rodando e um par
+        (valor, id) por evento na ordem de abertura. Se o grupo foi
+        multiplexado, os valores são escalados por habilitado/rodando.
+    */
+    if (this->leader < 0) return;
+    ioctl(this->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t buf[3 + 2 * PERF_NUM_EVENTS];
+    if (read(this->leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+    uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+    double escala = running > 0 ? (double)enabled / running : 0.0;
+    uint64_t k = 0;
+    for (int e = 0; e < PERF_NUM_EVENTS && k < nr; ++e) {
+        if (this->fd[e] < 0) continue;
+        this->value[e] += buf[3 + 2 * k] * escala;
+        k++;
+    }
+}
+
+#else
+
+perfCounters::perfCounters() : leader(-1), err("perf_event_open so existe no Linux") {
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e) this->fd[e] = -1;
+    this->reset();
+}
+
+perfCounters::~perfCounters() {}
+void perfCounters::start() {}
+void perfCounters::stop() {}
+
+#endif
+
+bool perfCounters::available() const {
+    return this->leader >= 0;
+}
+
+bool perfCounters::has(perfEvent e) const {
+    return this->fd[e] >= 0;
+}
+
+const string& perfCounters::error() const {
+    return this->err;
+}
+
+void perfCounters::reset() {
+    for (int e = 0; e < PERF_NUM_EVENTS; ++e) this->value[e] = 0.0;
+}
@@ -0,0 +1,46 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <string>
+
+using namespace std;
+
+// Eventos lidos por perfCounters, na ordem de value[]
+enum perfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NUM_EVENTS
+};
+
+// Contadores de hardware do Linux (perf_event_open) para a thread atual,
+// lidos em grupo em volta de um lote de consultas. Eventos que o
+// processador ou o kernel não oferecem ficam indisponíveis sem derrubar
+// os demais; se nenhum abrir, available() é falso e error() diz por quê.
+class perfCounters {
+public:
+    perfCounters();
+    ~perfCounters();
+
+    bool available() const;
+    bool has(perfEvent e) const;
+    const string& error() const;
+
+    void start();
+    void stop();                        // acumula em value[] desde o start
+
+    void reset();
+    double value[PERF_NUM_EVENTS];      // escalados se houve multiplexação
+
+private:
+    int fd[PERF_NUM_EVENTS];
+    int leader;
+    string err;
+
+    perfCounters(const perfCounters&) = delete;
+    perfCounters& operator=(const perfCounters&) = delete;
+};
+
+#endif
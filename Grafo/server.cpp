@@ -0,0 +1,576 @@
+#include "graph.h"
+#include "parallel.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <csignal>
+#include <cerrno>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Servidor local de consultas
+
+    Carrega o grafo uma vez e responde consultas de vários clientes por um
+    socket Unix (--socket CAMINHO) ou pela entrada/saída padrão. Protocolo
+    de linhas; cada requisição gera uma resposta, na mesma ordem em que as
+    requisições chegaram na conexão:
+
+        rel <substantivo>          ok <k>, seguido de k linhas sujeito\tverbo\tobjeto
+        bfs <origem> <destino>     ok <n> no1 no2 ...   (n = 0: sem caminho)
+        bfsh <origem> <destino>    idem, BFS hierárquica
+        dijkstra <origem> <destino> idem, Dijkstra
+        stats                      ok requests=... p50_us=... p99_us=... max_us=...
+        quit                       fecha a conexão
+
+    Erros são respondidos com "err <mensagem>". O cliente pode enviar várias
+    requisições sem esperar as respostas (pipelining); as linhas completas
+    lidas de uma conexão numa volta do laço de eventos formam um lote que
+    vai inteiro para um trabalhador (micro-batching).
+
+    Compilação:
+        g++ -O2 -pthread server.cpp graph.cpp components.cpp -o grafo_server
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+typedef chrono::steady_clock clock_type;
+
+static const size_t MAX_BATCH = 64;         // requisições por lote
+static const size_t MAX_LINE = 1 << 16;     // linha maior que isso fecha a conexão
+static const int LAT_BUCKETS = 32;          // histograma log2 em microssegundos
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void onSignal(int) {
+    stop_requested = 1;
+}
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/*------------------------------------------------------------------------------
+    Métricas de latência
+------------------------------------------------------------------------------*/
+
+// Histograma por trabalhador: só o dono escreve, o comando stats soma todos
+class latencyStats {
+public:
+    atomic<unsigned long long> bucket[LAT_BUCKETS];
+    atomic<unsigned long long> count{0};
+    atomic<unsigned long long> total_us{0};
+    atomic<unsigned long long> max_us{0};
+    atomic<unsigned long long> batches{0};
+
+    latencyStats() {
+        for (int i = 0; i < LAT_BUCKETS; ++i) this->bucket[i].store(0);
+    }
+
+    void record(unsigned long long us) {
+        int b = 0;
+        while (b + 1 < LAT_BUCKETS && (1ULL << b) <= us) b++;
+        this->bucket[b].fetch_add(1, memory_order_relaxed);
+        this->count.fetch_add(1, memory_order_relaxed);
+        this->total_us.fetch_add(us, memory_order_relaxed);
+        if (us > this->max_us.load(memory_order_relaxed))
+            this->max_us.store(us, memory_order_relaxed);
+    }
+};
+
+static string formatStats(const vector<latencyStats*>& all) {
+    /*
+        Soma os histogramas. Os percentis são o limite superior do balde
+        (potência de 2), então são aproximados por excesso, mas nunca passam
+        do máximo observado.
+    */
+    unsigned long long hist[LAT_BUCKETS] = {0};
+    unsigned long long n = 0, total = 0, mx = 0, batches = 0;
+    for (latencyStats* s : all) {
+        for (int i = 0; i < LAT_BUCKETS; ++i) hist[i] += s->bucket[i].load(memory_order_relaxed);
+        n += s->count.load(memory_order_relaxed);
+        total += s->total_us.load(memory_order_relaxed);
+        mx = max(mx, s->max_us.load(memory_order_relaxed));
+        batches += s->batches.load(memory_order_relaxed);
+    }
+    auto percentile = [&](double p) -> unsigned long long {
+        unsigned long long alvo = (unsigned long long)(p * n), acc = 0;
+        for (int i = 0; i < LAT_BUCKETS; ++i) {
+            acc += hist[i];
+            if (acc > alvo) return min(1ULL << i, mx);
+        }
+        return mx;
+    };
+    ostringstream out;
+    out << "ok requests=" << n << " batches=" << batches
+        << " mean_us=" << (n ? total / n : 0)
+        << " p50_us=" << (n ? percentile(0.50) : 0)
+        << " p99_us=" << (n ? percentile(0.99) : 0)
+        << " max_us=" << mx;
+    return out.str();
+}
+
+/*------------------------------------------------------------------------------
+    Lotes e fila de trabalho
+------------------------------------------------------------------------------*/
+
+struct batch {
+    unsigned long long conn_id;
+    unsigned long long seq;             // ordem do lote na conexão
+    clock_type::time_point arrival;
+    vector<string> lines;
+    string response;
+};
+
+class workQueue {
+public:
+    void push(batch* b) {
+        {
+            lock_guard<mutex> lock(this->m);
+            this->q.push_back(b);
+        }
+        this->cv.notify_one();
+    }
+
+    // nullptr quando a fila foi fechada e esvaziada
+    batch* pop() {
+        unique_lock<mutex> lock(this->m);
+        this->cv.wait(lock, [this] { return this->closed || !this->q.empty(); });
+        if (this->q.empty()) return nullptr;
+        batch* b = this->q.front();
+        this->q.pop_front();
+        return b;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> lock(this->m);
+            this->closed = true;
+        }
+        this->cv.notify_all();
+    }
+
+private:
+    mutex m;
+    condition_variable cv;
+    deque<batch*> q;
+    bool closed = false;
+};
+
+// Lotes prontos voltam ao laço de eventos por esta fila + um byte no pipe
+class doneQueue {
+public:
+    int wake_fd = -1;
+
+    void push(batch* b) {
+        bool avisar;
+        {
+            lock_guard<mutex> lock(this->m);
+            avisar = this->q.empty();
+            this->q.push_back(b);
+        }
+        if (avisar) {
+            char c = 1;
+            while (write(this->wake_fd, &c, 1) < 0 && errno == EINTR) {}
+        }
+    }
+
+    void drain(vector<batch*>& out) {
+        lock_guard<mutex> lock(this->m);
+        out.insert(out.end(), this->q.begin(), this->q.end());
+        this->q.clear();
+    }
+
+private:
+    mutex m;
+    vector<batch*> q;
+};
+
+/*------------------------------------------------------------------------------
+    Trabalhadores
+------------------------------------------------------------------------------*/
+
+// Estado reaproveitado por cada trabalhador entre requisições
+class worker {
+public:
+    worker(const graph& G, const vector<latencyStats*>& all)
+        : G(G), all(all), rel(rel_buf, REL_TSV) {}
+
+    latencyStats stats;
+
+    void run(workQueue& work, doneQueue& done) {
+        batch* b;
+        while ((b = work.pop()) != nullptr) {
+            b->response.clear();
+            for (const string& line : b->lines) {
+                this->execute(line, b->response);
+                b->response += '\n';
+                // Latência desde a chegada do lote até esta resposta ficar pronta
+                auto us = chrono::duration_cast<chrono::microseconds>(clock_type::now() - b->arrival).count();
+                this->stats.record((unsigned long long)us);
+            }
+            this->stats.batches.fetch_add(1, memory_order_relaxed);
+            done.push(b);
+        }
+    }
+
+private:
+    const graph& G;
+    const vector<latencyStats*>& all;
+    ostringstream rel_buf;
+    relationWriter rel;
+    vector<string> args;
+    searchWorkspace search;             // dist/prev/visitados das buscas
+
+    void appendPath(const vector<int>& path, string& out) {
+        out += "ok ";
+        out += to_string(path.size());
+        for (int idx : path) {
+            out += ' ';
+            out += this->G.noun(idx);
+        }
+    }
+
+    void execute(const string& line, string& out) {
+        this->args.clear();
+        istringstream in(line);
+        string tok;
+        while (in >> tok) this->args.push_back(tok);
+        if (this->args.empty()) {
+            out += "err requisicao vazia";
+            return;
+        }
+        const string& cmd = this->args[0];
+
+        if (cmd == "stats" && this->args.size() == 1) {
+            out += formatStats(this->all);
+            return;
+        }
+        if (cmd == "rel" && this->args.size() == 2) {
+            int idx = this->G.nodeIndex(this->args[1]);
+            if (idx < 0) {
+                out += "err substantivo desconhecido: " + this->args[1];
+                return;
+            }
+            this->rel_buf.str(string());
+            this->rel.writeRelations(this->G, idx);
+            this->rel.flush();
+            out += "ok ";
+            out += to_string(this->G.a[idx].size());
+            out += '\n';
+            string s = this->rel_buf.str();
+            if (!s.empty() && s.back() == '\n') s.pop_back();
+            out += s;
+            return;
+        }
+        if ((cmd == "bfs" || cmd == "bfsh" || cmd == "dijkstra") && this->args.size() == 3) {
+            int s = this->G.nodeIndex(this->args[1]);
+            int e = this->G.nodeIndex(this->args[2]);
+            if (s < 0 || e < 0) {
+                out += "err substantivo desconhecido: " + (s < 0 ? this->args[1] : this->args[2]);
+                return;
+            }
+            if (cmd == "bfs") this->appendPath(this->G.bfs(s, e, this->search), out);
+            else if (cmd == "bfsh") this->appendPath(this->G.bfsHierarchical(s, e, this->search), out);
+            else this->appendPath(this->G.dijkstra(s, e, this->search), out);
+            return;
+        }
+        out += "err comando invalido: " + cmd;
+    }
+};
+
+/*------------------------------------------------------------------------------
+    Conexões e laço de eventos
+------------------------------------------------------------------------------*/
+
+struct connection {
+    unsigned long long id;
+    int fd_in, fd_out;
+    string inbuf, outbuf;
+    unsigned long long next_seq = 0;    // próximo lote a enviar
+    unsigned long long sent_seq = 0;    // próximo lote a ser criado
+    map<unsigned long long, batch*> ready;  // lotes prontos fora de ordem
+    bool read_closed = false;           // EOF ou quit: não lê mais
+    bool broken = false;                // erro de escrita: descarta tudo
+};
+
+static void closeConnection(connection* c) {
+    for (auto& kv : c->ready) delete kv.second;
+    c->ready.clear();
+    if (c->fd_in >= 0) close(c->fd_in);
+    if (c->fd_out >= 0 && c->fd_out != c->fd_in) close(c->fd_out);
+}
+
+static int openListener(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0 || !setNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void readRequests(connection* c, workQueue& work) {
+    /*
+        Lê tudo o que estiver disponível e despacha as linhas completas em
+        lotes de até MAX_BATCH. "quit" encerra a leitura; as respostas
+        anteriores ainda são enviadas.
+    */
+    char buf[1 << 14];
+    for (;;) {
+        ssize_t r = read(c->fd_in, buf, sizeof(buf));
+        if (r > 0) { c->inbuf.append(buf, r); continue; }
+        if (r == 0) c->read_closed = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) c->read_closed = true;
+        break;
+    }
+
+    batch* b = nullptr;
+    size_t pos = 0;
+    bool quit = false;
+    while (!quit) {
+        size_t nl = c->inbuf.find('\n', pos);
+        if (nl == string::npos) {
+            // Última linha sem '\n' antes do EOF
+            if (!c->read_closed || pos == c->inbuf.size()) break;
+            nl = c->inbuf.size();
+        }
+        string line = c->inbuf.substr(pos, nl - pos);
+        pos = min(nl + 1, c->inbuf.size());
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line == "quit") { quit = true; break; }
+        if (b == nullptr) {
+            b = new batch;
+            b->conn_id = c->id;
+            b->seq = c->sent_seq++;
+            b->arrival = clock_type::now();
+        }
+        b->lines.push_back(line);
+        if (b->lines.size() == MAX_BATCH) { work.push(b); b = nullptr; }
+    }
+    if (b != nullptr) work.push(b);
+    c->inbuf.erase(0, pos);
+    if (quit) {
+        c->read_closed = true;
+        c->inbuf.clear();
+    } else if (c->inbuf.size() > MAX_LINE) {
+        cerr << "Erro: Linha muito longa, fechando conexao." << endl;
+        c->read_closed = true;
+        c->inbuf.clear();
+    }
+}
+
+static void writeResponses(connection* c) {
+    while (!c->outbuf.empty()) {
+        ssize_t w = write(c->fd_out, c->outbuf.data(), c->outbuf.size());
+        if (w > 0) { c->outbuf.erase(0, w); continue; }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        c->broken = true;
+        return;
+    }
+}
+
+int main(int argc, char** argv) {
+    string data_path = "data.txt";
+    string socket_path;
+    int num_workers = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) num_workers = atoi(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-') data_path = arg;
+        else {
+            cerr << "Uso: " << argv[0] << " [data.txt] [--socket CAMINHO] [--workers N]" << endl;
+            return 1;
+        }
+    }
+    num_workers = defaultThreads(num_workers);
+
+    ifstream F(data_path);
+    if (!F.is_open()) {
+        cerr << "Erro: Nao foi possivel abrir o arquivo " << data_path << "." << endl;
+        return 1;
+    }
+    graph G;
+    G.load(F);
+    F.close();
+    G.addHierarchicalVerb("eh");
+    G.addHierarchicalVerb("e");
+    // Construído antes dos trabalhadores. Os trabalhadores só recebem o grafo
+    // como const: as buscas com searchWorkspace e mayReach não escrevem nele
+    G.buildComponentIndex();
+    cerr << "Grafo carregado: " << G.size() << " nos, " << num_workers << " trabalhadores." << endl;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int wake[2];
+    if (pipe(wake) < 0 || !setNonBlocking(wake[0])) {
+        cerr << "Erro: Nao foi possivel criar o pipe de notificacao." << endl;
+        return 1;
+    }
+
+    workQueue work;
+    doneQueue done;
+    done.wake_fd = wake[1];
+
+    vector<latencyStats*> all_stats;
+    vector<worker*> workers;
+    for (int i = 0; i < num_workers; ++i) {
+        workers.push_back(new worker(G, all_stats));
+        all_stats.push_back(&workers.back()->stats);
+    }
+    vector<thread> pool;
+    for (worker* w : workers)
+        pool.emplace_back([w, &work, &done] { w->run(work, done); });
+
+    int listen_fd = -1;
+    unsigned long long next_id = 0;
+    map<unsigned long long, connection*> conns;
+    if (!socket_path.empty()) {
+        listen_fd = openListener(socket_path);
+        if (listen_fd < 0) {
+            cerr << "Erro: Nao foi possivel escutar em " << socket_path << ": " << strerror(errno) << endl;
+            stop_requested = 1;
+        }
+    } else {
+        connection* c = new connection;
+        c->id = next_id++;
+        c->fd_in = STDIN_FILENO;
+        c->fd_out = STDOUT_FILENO;
+        setNonBlocking(c->fd_in);
+        setNonBlocking(c->fd_out);
+        conns[c->id] = c;
+    }
+
+    vector<pollfd> fds;
+    vector<unsigned long long> fd_conn;    // conexão de cada pollfd (além dos fixos)
+    vector<batch*> finished;
+    while (!stop_requested) {
+        // No modo stdin o servidor termina quando a única conexão termina
+        if (listen_fd < 0 && conns.empty()) break;
+
+        fds.clear();
+        fd_conn.clear();
+        fds.push_back(pollfd{wake[0], POLLIN, 0});
+        if (listen_fd >= 0) fds.push_back(pollfd{listen_fd, POLLIN, 0});
+        size_t fixed_fds = fds.size();
+        for (auto& kv : conns) {
+            connection* c = kv.second;
+            if (!c->read_closed) {
+                fds.push_back(pollfd{c->fd_in, POLLIN, 0});
+                fd_conn.push_back(c->id);
+            }
+            if (!c->outbuf.empty()) {
+                fds.push_back(pollfd{c->fd_out, POLLOUT, 0});
+                fd_conn.push_back(c->id);
+            }
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            cerr << "Erro: poll falhou: " << strerror(errno) << endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char tmp[256];
+            while (read(wake[0], tmp, sizeof(tmp)) > 0) {}
+        }
+        if (listen_fd >= 0 && (fds[1].revents & POLLIN)) {
+            int cfd;
+            while ((cfd = accept(listen_fd, nullptr, nullptr)) >= 0) {
+                setNonBlocking(cfd);
+                connection* c = new connection;
+                c->id = next_id++;
+                c->fd_in = c->fd_out = cfd;
+                conns[c->id] = c;
+            }
+        }
+
+        for (size_t i = fixed_fds; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) continue;
+            auto it = conns.find(fd_conn[i - fixed_fds]);
+            if (it == conns.end()) continue;
+            connection* c = it->second;
+            if (fds[i].events & POLLIN) readRequests(c, work);
+            else writeResponses(c);
+            if (fds[i].revents & (POLLERR | POLLNVAL)) c->broken = true;
+        }
+
+        // Reordena os lotes prontos e escreve o que já estiver em sequência
+        finished.clear();
+        done.drain(finished);
+        for (batch* b : finished) {
+            auto it = conns.find(b->conn_id);
+            if (it == conns.end()) { delete b; continue; }
+            it->second->ready[b->seq] = b;
+        }
+        for (auto it = conns.begin(); it != conns.end(); ) {
+            connection* c = it->second;
+            while (!c->ready.empty() && c->ready.begin()->first == c->next_seq) {
+                batch* b = c->ready.begin()->second;
+                c->outbuf += b->response;
+                c->ready.erase(c->ready.begin());
+                c->next_seq++;
+                delete b;
+            }
+            if (!c->outbuf.empty()) writeResponses(c);
+            bool pendente = c->next_seq != c->sent_seq || !c->outbuf.empty();
+            if (c->broken || (c->read_closed && !pendente)) {
+                closeConnection(c);
+                delete c;
+                it = conns.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    work.close();
+    for (thread& t : pool) t.join();
+    // Lotes ainda não entregues (parada por sinal) são descartados
+    finished.clear();
+    done.drain(finished);
+    for (batch* b : finished) delete b;
+    for (auto& kv : conns) {
+        closeConnection(kv.second);
+        delete kv.second;
+    }
+    for (worker* w : workers) delete w;
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+    close(wake[0]);
+    close(wake[1]);
+    return 0;
+}
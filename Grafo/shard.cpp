@@ -0,0 +1,589 @@
+#include "shard.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Mensagens entre coordenador e partições
+
+    Cada mensagem é um cabeçalho (tipo, tamanho; 32 bits cada) seguido do
+    conteúdo. As mensagens são em lote: uma por partição por nível da BFS,
+    e a carga das triplas é agrupada em blocos de até LOAD_BATCH bytes.
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+enum {
+    MSG_LOAD,           // registros de nó/arco
+    MSG_BEGIN,          // origem, destino: zera a busca
+    MSG_LEVEL,          // nível, entradas (nó, pai) vindas de outras partições
+    MSG_LEVEL_DONE,     // resposta de um nível
+    MSG_PARENT,         // nó: pergunta o pai na árvore da última busca
+    MSG_PARENT_REPLY,
+    MSG_STATS,
+    MSG_STATS_REPLY,
+    MSG_EXIT
+};
+
+enum { REC_NODE, REC_ARC };
+
+static const size_t LOAD_BATCH = 1 << 16;
+static const unsigned long long NO_KEY = ~0ULL;
+
+static unsigned long long nounKey(const string& S) {
+    /*
+        FNV-1a de 64 bits. NO_KEY é reservado para "sem nó".
+    */
+    unsigned long long h = 1469598103934665603ULL;
+    for (unsigned char c : S) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h == NO_KEY ? h - 1 : h;
+}
+
+static void putU32(string& b, unsigned int v) { b.append((const char*)&v, 4); }
+static void putU64(string& b, unsigned long long v) { b.append((const char*)&v, 8); }
+static void putStr(string& b, const string& s) { putU32(b, s.size()); b += s; }
+
+// Leitura sequencial de um conteúdo de mensagem
+struct msgReader {
+    const string& s;
+    size_t p = 0;
+    explicit msgReader(const string& s) : s(s) {}
+    bool more() const { return this->p < this->s.size(); }
+    unsigned int u32() { unsigned int v; this->s.copy((char*)&v, 4, this->p); this->p += 4; return v; }
+    unsigned long long u64() { unsigned long long v; this->s.copy((char*)&v, 8, this->p); this->p += 8; return v; }
+    unsigned char u8() { return (unsigned char)this->s[this->p++]; }
+    string str() { unsigned int n = this->u32(); string r = this->s.substr(this->p, n); this->p += n; return r; }
+};
+
+static bool writeAll(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w; n -= w;
+    }
+    return true;
+}
+
+static bool readAll(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r; n -= r;
+    }
+    return true;
+}
+
+static bool sendFrame(int fd, unsigned int type, const string& payload) {
+    unsigned int hdr[2] = {type, (unsigned int)payload.size()};
+    return writeAll(fd, (const char*)hdr, sizeof(hdr)) && writeAll(fd, payload.data(), payload.size());
+}
+
+static bool recvFrame(int fd, unsigned int& type, string& payload) {
+    unsigned int hdr[2];
+    if (!readAll(fd, (char*)hdr, sizeof(hdr))) return false;
+    type = hdr[0];
+    payload.resize(hdr[1]);
+    return readAll(fd, &payload[0], hdr[1]);
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Processo de uma partição
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+namespace {
+
+struct shardArc {
+    unsigned long long to;
+    int local;                      // índice local do alvo, -1 se de outra partição
+    int verbo;
+};
+
+// Fatia do grafo guardada por uma partição: os nós dela (nd) e os arcos
+// que saem deles (a), com os alvos identificados pela chave global.
+struct shardState {
+    vector<string> nd;
+    vector<unsigned long long> key;
+    unordered_map<unsigned long long, int> local;
+    vector< vector<shardArc> > a;
+    vector<string> verbs;
+    unordered_map<string, int> verb_index;
+    bool dirty = false;             // arcos sem alvo local resolvido
+    long long num_arcs = 0;
+
+    // Busca atual
+    vector<int> dist;
+    vector<unsigned long long> parent;
+    vector<unsigned int> mark;
+    unsigned int generation = 0;
+    vector<int> frontier, next;
+    unsigned long long target = NO_KEY;
+    unordered_set<unsigned long long> sent;     // alvos remotos já enviados no nível
+
+    int nodeAppend(unsigned long long k, const string& S) {
+        auto it = this->local.find(k);
+        if (it != this->local.end()) return it->second;
+        int idx = this->nd.size();
+        this->local[k] = idx;
+        this->nd.push_back(S);
+        this->key.push_back(k);
+        this->a.push_back(vector<shardArc>());
+        this->dirty = true;
+        return idx;
+    }
+
+    void resolve() {
+        /*
+            Liga os arcos aos índices locais uma vez após a carga, para que
+            a BFS não consulte a tabela de hash por arco.
+        */
+        if (!this->dirty) return;
+        for (vector<shardArc>& adj : this->a)
+            for (shardArc& e : adj) {
+                auto it = this->local.find(e.to);
+                e.local = it == this->local.end() ? -1 : it->second;
+            }
+        size_t n = this->nd.size();
+        this->dist.resize(n);
+        this->parent.resize(n);
+        this->mark.assign(n, 0);
+        this->generation = 0;
+        this->dirty = false;
+    }
+
+    bool visited(int i) const { return this->mark[i] == this->generation; }
+
+    void visit(int i, int d, unsigned long long p) {
+        this->mark[i] = this->generation;
+        this->dist[i] = d;
+        this->parent[i] = p;
+    }
+
+    void onLoad(msgReader& r) {
+        while (r.more()) {
+            unsigned char kind = r.u8();
+            if (kind == REC_NODE) {
+                unsigned long long k = r.u64();
+                this->nodeAppend(k, r.str());
+            } else {
+                unsigned long long from = r.u64();
+                string S1 = r.str();
+                unsigned long long to = r.u64();
+                string V = r.str();
+                int u = this->nodeAppend(from, S1);
+                auto it = this->verb_index.find(V);
+                int v;
+                if (it == this->verb_index.end()) {
+                    v = this->verbs.size();
+                    this->verb_index[V] = v;
+                    this->verbs.push_back(V);
+                } else {
+                    v = it->second;
+                }
+                this->a[u].push_back(shardArc{to, -1, v});
+                this->num_arcs++;
+                this->dirty = true;
+            }
+        }
+    }
+
+    void onBegin(msgReader& r) {
+        this->resolve();
+        unsigned long long source = r.u64();
+        this->target = r.u64();
+        if (++this->generation == 0) {
+            fill(this->mark.begin(), this->mark.end(), 0);
+            this->generation = 1;
+        }
+        this->frontier.clear();
+        auto it = this->local.find(source);
+        if (it != this->local.end()) {
+            this->visit(it->second, 0, NO_KEY);
+            this->frontier.push_back(it->second);
+        }
+    }
+
+    void onLevel(msgReader& r, string& reply) {
+        /*
+            Aceita as entradas remotas do nível, expande a fronteira toda e
+            responde com os alvos remotos (sem repetição) para o próximo.
+        */
+        int level = r.u32();
+        unsigned int count = r.u32();
+        for (unsigned int k = 0; k < count; ++k) {
+            unsigned long long v = r.u64();
+            unsigned long long p = r.u64();
+            auto it = this->local.find(v);
+            if (it == this->local.end() || this->visited(it->second)) continue;
+            this->visit(it->second, level, p);
+            this->frontier.push_back(it->second);
+        }
+
+        auto t = this->local.find(this->target);
+        bool found = t != this->local.end() && this->visited(t->second);
+
+        unsigned long long local_edges = 0, cross_edges = 0;
+        string remote;
+        unsigned int remote_count = 0;
+        this->next.clear();
+        this->sent.clear();
+        if (!found) {
+            for (int u : this->frontier) {
+                for (const shardArc& e : this->a[u]) {
+                    if (e.local >= 0) {
+                        local_edges++;
+                        if (this->visited(e.local)) continue;
+                        this->visit(e.local, level + 1, this->key[u]);
+                        this->next.push_back(e.local);
+                    } else {
+                        cross_edges++;
+                        if (!this->sent.insert(e.to).second) continue;
+                        putU64(remote, e.to);
+                        putU64(remote, this->key[u]);
+                        remote_count++;
+                    }
+                }
+            }
+        }
+
+        reply.clear();
+        reply += (char)found;
+        putU32(reply, this->frontier.size());
+        putU32(reply, this->next.size());
+        putU64(reply, local_edges);
+        putU64(reply, cross_edges);
+        putU32(reply, remote_count);
+        reply += remote;
+        this->frontier.swap(this->next);
+    }
+
+    void onParent(msgReader& r, string& reply) {
+        unsigned long long k = r.u64();
+        reply.clear();
+        auto it = this->local.find(k);
+        bool ok = it != this->local.end() && !this->dirty && this->visited(it->second);
+        reply += (char)ok;
+        putU64(reply, ok ? this->parent[it->second] : NO_KEY);
+        putStr(reply, ok ? this->nd[it->second] : string());
+    }
+};
+
+void shardMain(int fd) {
+    shardState S;
+    unsigned int type;
+    string msg, reply;
+    while (recvFrame(fd, type, msg)) {
+        msgReader r(msg);
+        switch (type) {
+        case MSG_LOAD:
+            S.onLoad(r);
+            break;
+        case MSG_BEGIN:
+            S.onBegin(r);
+            break;
+        case MSG_LEVEL:
+            S.onLevel(r, reply);
+            if (!sendFrame(fd, MSG_LEVEL_DONE, reply)) return;
+            break;
+        case MSG_PARENT:
+            S.onParent(r, reply);
+            if (!sendFrame(fd, MSG_PARENT_REPLY, reply)) return;
+            break;
+        case MSG_STATS:
+            reply.clear();
+            putU64(reply, S.nd.size());
+            putU64(reply, S.num_arcs);
+            if (!sendFrame(fd, MSG_STATS_REPLY, reply)) return;
+            break;
+        case MSG_EXIT:
+            return;
+        default:
+            cerr << "Erro: Mensagem desconhecida na particao: " << type << endl;
+            return;
+        }
+    }
+}
+
+}
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Coordenador
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+shardedGraph::shardedGraph(int shards, shardPolicy policy)
+    : n(max(1, shards)), policy(policy) {
+}
+
+shardedGraph::~shardedGraph() {
+    this->stop();
+}
+
+bool shardedGraph::start() {
+    /*
+        Cria um processo por partição, ligado ao coordenador por um par de
+        sockets. Os filhos são criados antes da carga, então não herdam o
+        grafo.
+    */
+    signal(SIGPIPE, SIG_IGN);
+    this->out.assign(this->n, string());
+    this->load_count.assign(this->n, 0);
+    for (int i = 0; i < this->n; ++i) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+            cerr << "Erro: Nao foi possivel criar o socket da particao " << i << "." << endl;
+            this->stop();
+            return false;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            cerr << "Erro: Nao foi possivel criar o processo da particao " << i << "." << endl;
+            close(sv[0]);
+            close(sv[1]);
+            this->stop();
+            return false;
+        }
+        if (pid == 0) {
+            for (int fd : this->fds) close(fd);
+            close(sv[0]);
+            shardMain(sv[1]);
+            close(sv[1]);
+            _exit(0);
+        }
+        close(sv[1]);
+        this->fds.push_back(sv[0]);
+        this->pids.push_back(pid);
+    }
+    return true;
+}
+
+void shardedGraph::stop() {
+    for (size_t i = 0; i < this->fds.size(); ++i) {
+        sendFrame(this->fds[i], MSG_EXIT, string());
+        close(this->fds[i]);
+    }
+    for (pid_t pid : this->pids) waitpid(pid, nullptr, 0);
+    this->fds.clear();
+    this->pids.clear();
+}
+
+void shardedGraph::sendMsg(int shard, unsigned int type, const string& payload) {
+    this->counters.messages++;
+    this->counters.bytes += payload.size() + 8;
+    if (!sendFrame(this->fds[shard], type, payload))
+        cerr << "Erro: Falha ao enviar mensagem para a particao " << shard << "." << endl;
+}
+
+bool shardedGraph::recvMsg(int shard, unsigned int& type, string& payload) {
+    if (!recvFrame(this->fds[shard], type, payload)) {
+        cerr << "Erro: Falha ao receber mensagem da particao " << shard << "." << endl;
+        return false;
+    }
+    this->counters.messages++;
+    this->counters.bytes += payload.size() + 8;
+    return true;
+}
+
+int shardedGraph::ownerOf(unsigned long long key) const {
+    if (this->policy == SHARD_HASH) {
+        // Mistura os bits altos: o FNV distribui mal os bits baixos
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (int)(key % (unsigned long long)this->n);
+    }
+    auto it = this->owner_map.find(key);
+    return it == this->owner_map.end() ? -1 : it->second;
+}
+
+int shardedGraph::assign(unsigned long long key, int hint) {
+    /*
+        Corte guloso em fluxo: um nó novo vai para a partição do vizinho
+        (hint) se ela não estiver mais de ~10% acima da menos carregada;
+        senão vai para a menos carregada.
+    */
+    if (this->policy == SHARD_HASH) return this->ownerOf(key);
+    auto it = this->owner_map.find(key);
+    if (it != this->owner_map.end()) return it->second;
+    int menor = min_element(this->load_count.begin(), this->load_count.end()) - this->load_count.begin();
+    int s = menor;
+    if (hint >= 0 && this->load_count[hint] <= this->load_count[menor] + this->load_count[menor] / 10 + 16)
+        s = hint;
+    this->owner_map[key] = s;
+    this->load_count[s]++;
+    return s;
+}
+
+void shardedGraph::flushLoad(int shard) {
+    if (this->out[shard].empty()) return;
+    this->sendMsg(shard, MSG_LOAD, this->out[shard]);
+    this->out[shard].clear();
+}
+
+void shardedGraph::load(ifstream& F) {
+    /*
+        Lê as triplas em fluxo e manda cada arco ao dono do sujeito e o
+        objeto ao seu dono. O coordenador não guarda o grafo (em
+        SHARD_GREEDY guarda só o dono de cada nó).
+    */
+    string S1, V, S2;
+    while (F >> S1 >> V >> S2) {
+        unsigned long long k1 = nounKey(S1), k2 = nounKey(S2);
+        int o1 = this->assign(k1, this->ownerOf(k2));
+        int o2 = this->assign(k2, o1);
+
+        string& b1 = this->out[o1];
+        b1 += (char)REC_ARC;
+        putU64(b1, k1);
+        putStr(b1, S1);
+        putU64(b1, k2);
+        putStr(b1, V);
+        string& b2 = this->out[o2];
+        b2 += (char)REC_NODE;
+        putU64(b2, k2);
+        putStr(b2, S2);
+
+        this->counters.arcs++;
+        if (o1 != o2) this->counters.cut_arcs++;
+        if (b1.size() >= LOAD_BATCH) this->flushLoad(o1);
+        if (b2.size() >= LOAD_BATCH) this->flushLoad(o2);
+    }
+    for (int i = 0; i < this->n; ++i) this->flushLoad(i);
+}
+
+long long shardedGraph::runBfs(unsigned long long source, unsigned long long target, vector<long long>* levels) {
+    /*
+        BFS em níveis síncronos. Em cada nível o coordenador manda a cada
+        partição um lote com as entradas remotas que recebeu, espera todas
+        as respostas e encaminha os novos alvos remotos aos seus donos.
+        Termina quando o destino é visitado (retorna o nível) ou quando não
+        há mais fronteira (retorna -1).
+    */
+    for (int i = 0; i < this->n; ++i) this->flushLoad(i);
+    string begin;
+    putU64(begin, source);
+    putU64(begin, target);
+    for (int i = 0; i < this->n; ++i) this->sendMsg(i, MSG_BEGIN, begin);
+
+    vector<string> entries(this->n), next_entries(this->n);
+    vector<unsigned int> counts(this->n, 0), next_counts(this->n, 0);
+    string msg, reply;
+    for (int level = 0; ; ++level) {
+        for (int i = 0; i < this->n; ++i) {
+            msg.clear();
+            putU32(msg, level);
+            putU32(msg, counts[i]);
+            msg += entries[i];
+            this->sendMsg(i, MSG_LEVEL, msg);
+        }
+        this->counters.levels++;
+
+        bool found = false;
+        long long pending = 0, level_size = 0;
+        for (int i = 0; i < this->n; ++i) {
+            next_entries[i].clear();
+            next_counts[i] = 0;
+        }
+        for (int i = 0; i < this->n; ++i) {
+            unsigned int type;
+            if (!this->recvMsg(i, type, reply) || type != MSG_LEVEL_DONE) return -1;
+            msgReader r(reply);
+            found = r.u8() || found;
+            level_size += r.u32();
+            pending += r.u32();
+            this->counters.local_edges += r.u64();
+            this->counters.cross_edges += r.u64();
+            unsigned int remote = r.u32();
+            for (unsigned int k = 0; k < remote; ++k) {
+                unsigned long long v = r.u64();
+                unsigned long long p = r.u64();
+                int dono = this->ownerOf(v);
+                if (dono < 0) continue;
+                putU64(next_entries[dono], v);
+                putU64(next_entries[dono], p);
+                next_counts[dono]++;
+                pending++;
+            }
+            this->counters.routed += remote;
+        }
+        if (levels && level_size > 0) levels->push_back(level_size);
+        if (found) return level;
+        if (pending == 0) return -1;
+        entries.swap(next_entries);
+        counts.swap(next_counts);
+    }
+}
+
+vector<string> shardedGraph::bfs(const string& s, const string& t) {
+    vector<string> path;
+    if (this->fds.empty()) {
+        cerr << "Erro: Particoes nao iniciadas na BFS distribuida." << endl;
+        return path;
+    }
+    unsigned long long ks = nounKey(s), kt = nounKey(t);
+    if (this->ownerOf(ks) < 0 || this->ownerOf(kt) < 0) return path;
+    if (this->runBfs(ks, kt, nullptr) < 0) return path;
+
+    // Reconstrói o caminho perguntando o pai de cada nó ao seu dono
+    string msg, reply;
+    for (unsigned long long k = kt; k != NO_KEY; ) {
+        msg.clear();
+        putU64(msg, k);
+        int dono = this->ownerOf(k);
+        unsigned int type;
+        this->sendMsg(dono, MSG_PARENT, msg);
+        if (!this->recvMsg(dono, type, reply) || type != MSG_PARENT_REPLY) return vector<string>();
+        msgReader r(reply);
+        if (!r.u8()) return vector<string>();
+        k = r.u64();
+        path.push_back(r.str());
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+vector<long long> shardedGraph::bfsLevels(const string& s) {
+    vector<long long> levels;
+    if (this->fds.empty()) {
+        cerr << "Erro: Particoes nao iniciadas na BFS distribuida." << endl;
+        return levels;
+    }
+    unsigned long long ks = nounKey(s);
+    if (this->ownerOf(ks) < 0) return levels;
+    this->runBfs(ks, NO_KEY, &levels);
+    return levels;
+}
+
+void shardedGraph::shardSizes(vector<long long>& nodes, vector<long long>& arcs) {
+    nodes.assign(this->n, 0);
+    arcs.assign(this->n, 0);
+    string reply;
+    for (int i = 0; i < this->n; ++i) {
+        this->flushLoad(i);
+        this->sendMsg(i, MSG_STATS, string());
+    }
+    for (int i = 0; i < this->n; ++i) {
+        unsigned int type;
+        if (!this->recvMsg(i, type, reply) || type != MSG_STATS_REPLY) continue;
+        msgReader r(reply);
+        nodes[i] = r.u64();
+        arcs[i] = r.u64();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/types.h>
+
+using namespace std;
+
+// Como os nós são distribuídos entre as partições
+enum shardPolicy {
+    SHARD_HASH,     // hash do substantivo: dono calculável sem tabela
+    SHARD_GREEDY    // corte de arcos guloso em fluxo: nó vai para a partição
+                    // do vizinho já visto, respeitando o balanceamento
+};
+
+// Contadores acumulados pelo coordenador
+struct shardCounters {
+    long long levels = 0;           // níveis BSP executados
+    long long messages = 0;         // mensagens trocadas com as partições
+    long long bytes = 0;            // bytes dessas mensagens
+    long long local_edges = 0;      // arcos percorridos dentro de uma partição
+    long long cross_edges = 0;      // arcos percorridos entre partições
+    long long routed = 0;           // entradas de fronteira encaminhadas
+    long long cut_arcs = 0;         // arcos carregados que cruzam partições
+    long long arcs = 0;             // arcos carregados
+};
+
+// Grafo particionado em processos. Cada partição é um processo filho que
+// guarda só os seus nós (substantivos) e os arcos que saem deles; os nós
+// são identificados por um hash de 64 bits do substantivo. O coordenador
+// (este objeto) lê as triplas em fluxo, sem montar o grafo inteiro, e
+// executa a BFS em níveis síncronos: a cada nível cada partição expande
+// sua fronteira e devolve num único lote os alvos que pertencem a outras
+// partições, que o coordenador encaminha aos donos no nível seguinte.
+class shardedGraph {
+public:
+    shardedGraph(int shards, shardPolicy policy = SHARD_HASH);
+    ~shardedGraph();
+
+    bool start();                   // cria os processos das partições
+    void load(ifstream& F);         // mesmo formato de graph::load
+    void stop();
+
+    // Caminho de s a t (substantivos), vazio se não houver; mesmo contrato de graph::bfs
+    vector<string> bfs(const string& s, const string& t);
+    // Número de nós em cada nível da BFS completa a partir de s
+    vector<long long> bfsLevels(const string& s);
+
+    // Nós e arcos guardados em cada partição
+    void shardSizes(vector<long long>& nodes, vector<long long>& arcs);
+
+    int shards() const { return this->n; }
+    shardCounters counters;
+
+private:
+    int n;
+    shardPolicy policy;
+    vector<pid_t> pids;
+    vector<int> fds;                // socket do coordenador para cada partição
+    vector<string> out;             // lotes de carga ainda não enviados
+    unordered_map<unsigned long long, int> owner_map;   // só em SHARD_GREEDY
+    vector<long long> load_count;
+
+    int ownerOf(unsigned long long key) const;
+    int assign(unsigned long long key, int hint);
+    void sendMsg(int shard, unsigned int type, const string& payload);
+    bool recvMsg(int shard, unsigned int& type, string& payload);
+    void flushLoad(int shard);
+    long long runBfs(unsigned long long source, unsigned long long target, vector<long long>* levels);
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "graph.h"
+#include "parallel.h"
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Caminhos mínimos de fonte única: delta-stepping em paralelo
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+// Distância e predecessor empacotados numa palavra: comparar as palavras
+// compara primeiro a distância e, no empate, o menor predecessor. Assim um
+// único CAS atualiza os dois e o resultado não depende da ordem das threads.
+static const unsigned long long INF_STATE = ~0ULL;
+
+static inline unsigned long long pack(unsigned int d, int p) {
+    return ((unsigned long long)d << 32) | (unsigned int)p;
+}
+
+static inline unsigned int distOf(unsigned long long s) {
+    return (unsigned int)(s >> 32);
+}
+
+void graph::sssp(int start_node_idx, ssspWorkspace& W, int threads, int delta) const {
+    /*
+        Preenche W.dist e W.prev com a árvore de caminhos mínimos a partir de
+        start_node_idx sobre todo o grafo (pesos em arc::peso, não negativos).
+
+        Delta-stepping: os nós ficam em baldes de largura delta pela
+        distância; o balde atual é processado em paralelo relaxando todos os
+        arcos (atualização por CAS) e repetido enquanto receber nós. Cada
+        thread guarda seus próprios baldes e o próximo balde é montado com
+        uma soma atômica das posições. Com pesos unitários e delta = 1 isto é
+        uma BFS paralela por níveis.
+    */
+    const int n = this->size();
+    W.dist.assign(n, numeric_limits<int>::max());
+    W.prev.assign(n, -1);
+    if (start_node_idx < 0 || start_node_idx >= n) {
+        cerr << "Erro: Indice de no inicial invalido no SSSP." << endl;
+        return;
+    }
+
+    size_t m = 0;
+    long long soma_pesos = 0;
+    for (int u = 0; u < n; ++u) {
+        m += this->a[u].size();
+        for (const arc& e : this->a[u]) soma_pesos += e.peso;
+    }
+    if (delta <= 0)
+        delta = m > 0 ? max(1LL, soma_pesos / (long long)m) : 1;
+
+    if ((int)W.state.size() != n)
+        vector< atomic<unsigned long long> >(n).swap(W.state);
+    threads = defaultThreads(threads);
+    parallelFor(threads, n, [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) W.state[u].store(INF_STATE, memory_order_relaxed);
+    });
+    W.state[start_node_idx].store(pack(0, -1), memory_order_relaxed);
+
+    // Cada nó entra na fronteira no máximo uma vez por relaxamento bem sucedido
+    W.frontier.resize(m + 1);
+    W.frontier[0] = start_node_idx;
+
+    const size_t NO_BIN = numeric_limits<size_t>::max();
+    atomic<size_t> next_index[2];
+    atomic<size_t> frontier_tail[2];
+    atomic<size_t> cursor[2];
+    next_index[0].store(0); next_index[1].store(NO_BIN);
+    frontier_tail[0].store(1); frontier_tail[1].store(0);
+    cursor[0].store(0); cursor[1].store(0);
+    spinBarrier barrier(threads);
+    const size_t CHUNK = 64;
+
+    parallelRun(threads, [&](int tid) {
+        vector< vector<int> > local_bins;
+        size_t iter = 0;
+        while (next_index[iter & 1].load(memory_order_acquire) != NO_BIN) {
+            size_t curr_bin = next_index[iter & 1].load(memory_order_acquire);
+            atomic<size_t>& next_bin = next_index[(iter + 1) & 1];
+            size_t tail = frontier_tail[iter & 1].load(memory_order_acquire);
+            atomic<size_t>& next_tail = frontier_tail[(iter + 1) & 1];
+            atomic<size_t>& cur = cursor[iter & 1];
+
+            // Processa a fronteira em blocos distribuídos dinamicamente
+            for (;;) {
+                size_t b = cur.fetch_add(CHUNK, memory_order_relaxed);
+                if (b >= tail) break;
+                size_t e = min(tail, b + CHUNK);
+                for (size_t k = b; k < e; ++k) {
+                    int u = W.frontier[k];
+                    unsigned long long su = W.state[u].load(memory_order_relaxed);
+                    unsigned int du = distOf(su);
+                    // Entrada obsoleta: u já melhorou para um balde anterior
+                    if ((size_t)du / delta < curr_bin) continue;
+                    for (const arc& ed : this->a[u]) {
+                        int v = ed.to;
+                        if (v == start_node_idx) continue;
+                        unsigned long long novo = pack(du + (unsigned int)ed.peso, u);
+                        unsigned long long velho = W.state[v].load(memory_order_relaxed);
+                        while (novo < velho) {
+                            if (W.state[v].compare_exchange_weak(velho, novo,
+                                                                 memory_order_relaxed)) {
+                                size_t bin = (size_t)distOf(novo) / delta;
+                                if (bin >= local_bins.size()) local_bins.resize(bin + 1);
+                                local_bins[bin].push_back(v);
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Menor balde não vazio desta thread (a partir do atual)
+            for (size_t i = curr_bin; i < local_bins.size(); ++i) {
+                if (!local_bins[i].empty()) {
+                    size_t atual = next_bin.load(memory_order_relaxed);
+                    while (i < atual && !next_bin.compare_exchange_weak(atual, i)) {}
+                    break;
+                }
+            }
+            barrier.wait();
+            // Reserva a posição de cada thread na próxima fronteira
+            size_t nb = next_bin.load(memory_order_acquire);
+            size_t start = 0;
+            bool tem = nb < local_bins.size() && !local_bins[nb].empty();
+            if (tem)
+                start = next_tail.fetch_add(local_bins[nb].size());
+            barrier.wait();
+            if (tid == 0) {
+                next_index[iter & 1].store(NO_BIN, memory_order_relaxed);
+                frontier_tail[iter & 1].store(0, memory_order_relaxed);
+                cur.store(0, memory_order_relaxed);
+                if (next_tail.load() > W.frontier.size())
+                    W.frontier.resize(next_tail.load());
+            }
+            barrier.wait();
+            if (tem) {
+                copy(local_bins[nb].begin(), local_bins[nb].end(), W.frontier.begin() + start);
+                local_bins[nb].clear();
+            }
+            iter++;
+            barrier.wait();
+        }
+    });
+
+    parallelFor(threads, n, [&](int b, int e, int) {
+        for (int u = b; u < e; ++u) {
+            unsigned long long s = W.state[u].load(memory_order_relaxed);
+            if (s == INF_STATE) continue;
+            W.dist[u] = (int)distOf(s);
+            W.prev[u] = (int)(unsigned int)(s & 0xffffffffULL);
+        }
+    });
+}
@@ -0,0 +1,186 @@
+#include "triples.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+/*------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+    Índices de triplas
+--------------------------------------------------------------------------------
+------------------------------------------------------------------------------*/
+
+// Ordem dos campos em cada permutação
+static const tripleField ORDER_SPO[3] = {T_SUJEITO, T_VERBO, T_OBJETO};
+static const tripleField ORDER_POS[3] = {T_VERBO, T_OBJETO, T_SUJEITO};
+static const tripleField ORDER_OSP[3] = {T_OBJETO, T_SUJEITO, T_VERBO};
+
+static inline int field(const triple& t, tripleField f) {
+    return f == T_SUJEITO ? t.s : (f == T_VERBO ? t.p : t.o);
+}
+
+static inline int field(const triplePattern& P, tripleField f) {
+    return f == T_SUJEITO ? P.s : (f == T_VERBO ? P.p : P.o);
+}
+
+static void sortBy(vector<triple>& v, const tripleField order[3]) {
+    sort(v.begin(), v.end(), [order](const triple& x, const triple& y) {
+        for (int k = 0; k < 3; ++k) {
+            int a = field(x, order[k]), b = field(y, order[k]);
+            if (a != b) return a < b;
+        }
+        return false;
+    });
+}
+
+static void buildOffsets(const vector<triple>& v, tripleField f, size_t n, vector<size_t>& off) {
+    /*
+        off[x] .. off[x+1] é o intervalo das triplas com primeiro campo x.
+    */
+    off.assign(n + 1, 0);
+    for (const triple& t : v) off[field(t, f) + 1]++;
+    for (size_t x = 0; x < n; ++x) off[x + 1] += off[x];
+}
+
+void tripleIndex::build(const graph& G) {
+    /*
+        Monta o dicionário de verbos e as três permutações ordenadas.
+        Triplas repetidas no grafo aparecem uma vez só no índice.
+    */
+    this->verbs.clear();
+    this->verb_index.clear();
+    this->spo.clear();
+    for (int u = 0; u < G.size(); ++u) {
+        for (const arc& e : G.neighbors(u)) {
+            auto it = this->verb_index.find(e.verbo);
+            int p;
+            if (it == this->verb_index.end()) {
+                p = this->verbs.size();
+                this->verb_index[e.verbo] = p;
+                this->verbs.push_back(e.verbo);
+            } else {
+                p = it->second;
+            }
+            this->spo.push_back(triple{u, p, e.to});
+        }
+    }
+    sortBy(this->spo, ORDER_SPO);
+    this->spo.erase(unique(this->spo.begin(), this->spo.end(), [](const triple& x, const triple& y) {
+        return x.s == y.s && x.p == y.p && x.o == y.o;
+    }), this->spo.end());
+
+    this->pos = this->spo;
+    sortBy(this->pos, ORDER_POS);
+    this->osp = this->spo;
+    sortBy(this->osp, ORDER_OSP);
+
+    buildOffsets(this->spo, T_SUJEITO, G.size(), this->spo_off);
+    buildOffsets(this->pos, T_VERBO, this->verbs.size(), this->pos_off);
+    buildOffsets(this->osp, T_OBJETO, G.size(), this->osp_off);
+}
+
+int tripleIndex::verbId(const string& V) const {
+    auto it = this->verb_index.find(V);
+    return it == this->verb_index.end() ? -1 : it->second;
+}
+
+const string& tripleIndex::verb(int id) const {
+    return this->verbs[id];
+}
+
+tripleRange tripleIndex::match(const triplePattern& P) const {
+    /*
+        Escolhe a permutação em que os campos fixos formam um prefixo:
+        s / s,p / s,p,o / nenhum -> SPO;  p / p,o -> POS;  o / o,s -> OSP.
+        O primeiro campo sai da tabela de deslocamentos; os demais por
+        busca binária dentro desse intervalo.
+    */
+    bool bs = P.s != T_ANY, bp = P.p != T_ANY, bo = P.o != T_ANY;
+    const vector<triple>* idx;
+    const vector<size_t>* off;
+    const tripleField* order;
+    if (bs && (bp || !bo)) { idx = &this->spo; off = &this->spo_off; order = ORDER_SPO; }
+    else if (bp)           { idx = &this->pos; off = &this->pos_off; order = ORDER_POS; }
+    else if (bo)           { idx = &this->osp; off = &this->osp_off; order = ORDER_OSP; }
+    else                   { idx = &this->spo; off = &this->spo_off; order = ORDER_SPO; }
+
+    const triple* base = idx->data();
+    tripleRange r{base, base + idx->size()};
+    int first = field(P, order[0]);
+    if (first == T_ANY) return r;
+    if (first < 0 || (size_t)first + 1 >= off->size()) return tripleRange{base, base};
+    r.first = base + (*off)[first];
+    r.last = base + (*off)[first + 1];
+
+    // Restante do prefixo fixo, comparando os campos 2 e 3 da permutação
+    int k = 1;
+    while (k < 3 && field(P, order[k]) != T_ANY) k++;
+    if (k == 1) return r;
+    int v1 = field(P, order[1]);
+    int v2 = k == 3 ? field(P, order[2]) : 0;
+    auto less_key = [&](const triple& t) {
+        int a = field(t, order[1]);
+        if (a != v1) return a < v1;
+        return k == 3 && field(t, order[2]) < v2;
+    };
+    auto greater_key = [&](const triple& t) {
+        int a = field(t, order[1]);
+        if (a != v1) return a > v1;
+        return k == 3 && field(t, order[2]) > v2;
+    };
+    r.first = partition_point(r.first, r.last, less_key);
+    r.last = partition_point(r.first, r.last, [&](const triple& t) { return !greater_key(t); });
+    return r;
+}
+
+tripleRange tripleIndex::sorted(const triplePattern& P, tripleField f, vector<triple>& scratch) const {
+    /*
+        Intervalo de P ordenado pelo campo f. Na maioria dos casos o
+        intervalo do índice já vem nessa ordem (f fixo ou logo após o
+        prefixo); nos demais (ex.: sujeito fixo, junção pelo objeto) copia
+        e ordena.
+    */
+    tripleRange r = this->match(P);
+    auto by_f = [f](const triple& x, const triple& y) { return field(x, f) < field(y, f); };
+    if (is_sorted(r.begin(), r.end(), by_f)) return r;
+    scratch.assign(r.begin(), r.end());
+    stable_sort(scratch.begin(), scratch.end(), by_f);
+    return tripleRange{scratch.data(), scratch.data() + scratch.size()};
+}
+
+vector< pair<triple, triple> > tripleIndex::join(const triplePattern& A, tripleField fa,
+                                                 const triplePattern& B, tripleField fb) const {
+    /*
+        Junção por merge: percorre os dois intervalos ordenados pela
+        variável comum e, para cada valor presente nos dois, emite o
+        produto dos trechos iguais. Sujeito/objeto só se juntam com
+        sujeito/objeto (mesmo espaço de índices); verbo só com verbo.
+    */
+    vector< pair<triple, triple> > result;
+    if ((fa == T_VERBO) != (fb == T_VERBO)) {
+        cerr << "Erro: Juncao entre verbo e substantivo no indice de triplas." << endl;
+        return result;
+    }
+    vector<triple> scratch_a, scratch_b;
+    tripleRange ra = this->sorted(A, fa, scratch_a);
+    tripleRange rb = this->sorted(B, fb, scratch_b);
+
+    const triple* i = ra.begin();
+    const triple* j = rb.begin();
+    while (i != ra.end() && j != rb.end()) {
+        int x = field(*i, fa), y = field(*j, fb);
+        if (x < y) { ++i; continue; }
+        if (y < x) { ++j; continue; }
+        const triple* i_end = i;
+        while (i_end != ra.end() && field(*i_end, fa) == x) ++i_end;
+        const triple* j_end = j;
+        while (j_end != rb.end() && field(*j_end, fb) == x) ++j_end;
+        for (const triple* p = i; p != i_end; ++p)
+            for (const triple* q = j; q != j_end; ++q)
+                result.push_back(make_pair(*p, *q));
+        i = i_end;
+        j = j_end;
+    }
+    return result;
+}
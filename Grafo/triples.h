@@ -0,0 +1,72 @@
+#ifndef TRIPLES_H
+#define TRIPLES_H
+
+#include "graph.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// Tripla (sujeito, verbo, objeto): sujeito e objeto são índices de nós do
+// grafo, o verbo é um índice no dicionário de verbos do tripleIndex.
+struct triple {
+    int s;
+    int p;
+    int o;
+};
+
+// Posições de uma tripla
+enum tripleField { T_SUJEITO, T_VERBO, T_OBJETO };
+
+static const int T_ANY = -1;
+
+// Padrão com curingas: T_ANY em qualquer posição casa com tudo
+struct triplePattern {
+    int s = T_ANY;
+    int p = T_ANY;
+    int o = T_ANY;
+};
+
+// Intervalo contíguo de triplas que casam com um padrão
+class tripleRange {
+public:
+    const triple* first;
+    const triple* last;
+
+    const triple* begin() const { return first; }
+    const triple* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+};
+
+// Índices de permutação SPO, POS e OSP sobre as relações do grafo. Todo
+// padrão com qualquer combinação de curingas vira um intervalo contíguo
+// de um dos três vetores ordenados: O(1) quando só uma posição está fixa
+// (tabela de deslocamentos pelo primeiro campo), O(log) quando há mais.
+// É uma fotografia: depois de arcAppend é preciso chamar build de novo.
+class tripleIndex {
+public:
+    void build(const graph& G);
+
+    int verbId(const string& V) const;          // -1 se o verbo não existe
+    const string& verb(int id) const;
+    size_t size() const { return this->spo.size(); }
+
+    tripleRange match(const triplePattern& P) const;
+
+    // Junção por merge de dois padrões numa variável comum: pares (x, y)
+    // com x casando com A, y com B e x.fa == y.fb
+    vector< pair<triple, triple> > join(const triplePattern& A, tripleField fa,
+                                        const triplePattern& B, tripleField fb) const;
+
+private:
+    vector<string> verbs;
+    unordered_map<string, int> verb_index;
+    vector<triple> spo, pos, osp;
+    vector<size_t> spo_off, pos_off, osp_off;   // início de cada valor do primeiro campo
+
+    tripleRange sorted(const triplePattern& P, tripleField f, vector<triple>& scratch) const;
+};
+
+#endif